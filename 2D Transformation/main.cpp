@@ -3,6 +3,7 @@
 #include<iostream>
 #include<vector>
 #include<cmath>
+#include "../Lab2/polygonFill.h"
 
 using namespace std;
 
@@ -104,6 +105,13 @@ vector<vertex> userInput() {
     return vertices;
 }
 
+FillRule SelectFillRule() {
+    int choice;
+    cout << "fill the shape by 1. even-odd or 2. nonzero rule?" << endl;
+    cin >> choice;
+    return choice == 2 ? FillRule::NonZero : FillRule::EvenOdd;
+}
+
 Transform SelectTransform() {
     int choice;
     cout << "enter 1 for translation,\n2 for rotation,\n3 for scaling,\n4 for reflection,\n5 for shearing,\n6 for composition" << endl;
@@ -212,7 +220,64 @@ Transform SelectTransform() {
     return { {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}} }; // Fallback
 }
 
-void DrawScene(GLuint shaderProgram, const vector<vertex>& points, const Transform& transformMatrix) {
+// Fills the transformed outline on the CPU with the scanline filler and
+// returns one GL_LINES pair per span, so concave and self-crossing shapes
+// fill correctly without triangulating them. The filler works in window
+// pixels of a width x height window, the shapes are given in NDC.
+vector<float> FillLines(const vector<vertex>& points, const Transform& t, FillRule rule, int width, int height) {
+    vector<Point> pixels;
+    for (const auto& v : points) {
+        float x = t.matrix[0][0] * v.x + t.matrix[0][1] * v.y + t.matrix[0][2];
+        float y = t.matrix[1][0] * v.x + t.matrix[1][1] * v.y + t.matrix[1][2];
+        pixels.push_back({ (x + 1) * 0.5f * width, (y + 1) * 0.5f * height });
+    }
+
+    vector<float> lines;
+    for (const Span& s : FillPolygon(pixels, rule)) {
+        // from the left edge of the first pixel to the right edge of the last, through the row centre
+        float y = (s.y1 + 0.5f) / height * 2 - 1;
+        lines.insert(lines.end(), { s.x1 / width * 2 - 1, y, (s.x2 + 1) / width * 2 - 1, y });
+    }
+    return lines;
+}
+
+// fill lines kept on the GPU, the shapes never change so they are uploaded once
+struct FillBuffer {
+    GLuint VAO = 0, VBO = 0;
+    GLsizei count = 0;
+};
+
+FillBuffer UploadLines(const vector<float>& lines) {
+    FillBuffer buffer;
+    buffer.count = (GLsizei)(lines.size() / 2);
+    glGenVertexArrays(1, &buffer.VAO);
+    glGenBuffers(1, &buffer.VBO);
+    glBindVertexArray(buffer.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.VBO);
+    glBufferData(GL_ARRAY_BUFFER, lines.size() * sizeof(float), lines.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    return buffer;
+}
+
+void DeleteLines(FillBuffer& buffer) {
+    glDeleteVertexArrays(1, &buffer.VAO);
+    glDeleteBuffers(1, &buffer.VBO);
+    buffer = FillBuffer();
+}
+
+void DrawLines(GLint transformLoc, GLint colorLoc, const FillBuffer& lines, float r, float g, float b) {
+    if (lines.count == 0) return;
+
+    Transform identity;
+    glBindVertexArray(lines.VAO);
+    glUniformMatrix3fv(transformLoc, 1, GL_FALSE, &identity.matrix[0][0]);
+    glUniform4f(colorLoc, r, g, b, 1.0f);
+    glDrawArrays(GL_LINES, 0, lines.count);
+}
+
+void DrawScene(GLuint shaderProgram, const vector<vertex>& points, const Transform& transformMatrix,
+    const FillBuffer& originalFill, const FillBuffer& transformedFill) {
     glUseProgram(shaderProgram);
     GLint transformLoc = glGetUniformLocation(shaderProgram, "uTransform");
     GLint colorLoc = glGetUniformLocation(shaderProgram, "uColor");
@@ -254,6 +319,10 @@ void DrawScene(GLuint shaderProgram, const vector<vertex>& points, const Transfo
     glUniform4f(colorLoc, 1.0f, 1.0f, 1.0f, 1.0f);
     glDrawArrays(GL_LINES, 0, 4);
 
+    // === Fill both shapes (DARK GREEN, DARK RED) ===
+    DrawLines(transformLoc, colorLoc, originalFill, 0.0f, 0.35f, 0.0f);
+    DrawLines(transformLoc, colorLoc, transformedFill, 0.35f, 0.0f, 0.0f);
+
     // === Draw Original Shape (GREEN) ===
     glBindVertexArray(VAO);
 
@@ -312,6 +381,11 @@ int main() {
 
     vector<vertex> userInputPoints = userInput();
     Transform transform = SelectTransform();
+    FillRule rule = SelectFillRule();
+
+    // the shapes never change, so they are filled and uploaded once
+    FillBuffer originalFill = UploadLines(FillLines(userInputPoints, Transform(), rule, WIDTH, HEIGHT));
+    FillBuffer transformedFill = UploadLines(FillLines(userInputPoints, transform, rule, WIDTH, HEIGHT));
 
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
@@ -346,12 +420,14 @@ int main() {
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        DrawScene(shaderProgram, userInputPoints, transform);
+        DrawScene(shaderProgram, userInputPoints, transform, originalFill, transformedFill);
 
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    DeleteLines(originalFill);
+    DeleteLines(transformedFill);
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,1294 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <algorithm>
+#include <cstdio>
+#include "primitives.h"
+#include "lineBatch.h"
+#include "framebuffer.h"
+#include "wuLine.h"
+#include "simd.h"
+#include "primitiveBatch.h"
+#include "primitiveFile.h"
+#include "sweep.h"
+#include "curves.h"
+#include "voxelTraversal.h"
+#include "polygonFill.h"
+#include "regionFill.h"
+#include "viewportClip.h"
+#include "pointStream.h"
+#include "shapeCache.h"
+#include "occupancy.h"
+#include "mortonOrder.h"
+#include "linePattern.h"
+#include "polyline.h"
+
+using namespace std;
+
+// Standalone benchmarks for the Lab2 algorithms, no window or GL needed.
+// Run with no arguments for everything or pass benchmark names.
+// "sweep" is a separate mode with its own options, see sweep.h.
+
+
+typedef std::chrono::steady_clock Clock;
+
+static double SecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// keeps the optimizer from dropping results nobody reads
+static volatile float sink;
+
+
+// random lines of length [minLen, maxLen], in every direction unless axisMajor is set
+static LineBatch RandomLines(size_t n, float minLen, float maxLen, bool axisMajor, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> len(minLen, maxLen), angle(0.0f, 6.2831853f), pos(0.0f, (float)WIDTH);
+    LineBatch lines;
+    for (size_t i = 0; i < n; i++) {
+        float a = axisMajor ? (rng() % 4) * 1.5707963f : angle(rng);
+        float l = len(rng);
+        float x = std::round(pos(rng)), y = std::round(pos(rng));
+        lines.add(x, y, std::round(x + l * std::cos(a)), std::round(y + l * std::sin(a)));
+    }
+    return lines;
+}
+
+
+static void BenchDDABatch() {
+    struct Workload { const char* name; size_t lines; float minLen, maxLen; bool axisMajor; };
+    const Workload workloads[] = {
+        { "short", 1000000, 1, 16, false },
+        { "long", 20000, 500, 1000, false },
+        { "mixed-slope", 200000, 1, 1000, false },
+        { "axis", 200000, 1, 1000, true },
+    };
+
+    std::cout << "dda-batch (" << DDABatchISA() << ")\n";
+    for (const Workload& w : workloads) {
+        LineBatch lines = RandomLines(w.lines, w.minLen, w.maxLen, w.axisMajor, 42);
+
+        // current function, one vector per line
+        Clock::time_point start = Clock::now();
+        size_t points = 0;
+        for (size_t i = 0; i < lines.size(); i++) {
+            std::vector<Point> line = DDA(lines.x1[i], lines.y1[i], lines.x2[i], lines.y2[i]);
+            points += line.size();
+            sink = line.back().x;
+        }
+        double scalarTime = SecondsSince(start);
+
+        // batch kernel into one preallocated buffer, allocated outside the timing
+        std::vector<size_t> offsets;
+        std::vector<Point> out(DDABatchOffsets(lines, offsets));
+        start = Clock::now();
+        DDABatch(lines, offsets.data(), out.data());
+        double batchTime = SecondsSince(start);
+        sink = out.back().y;
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < lines.size(); i++) {
+            std::vector<Point> line = DDA(lines.x1[i], lines.y1[i], lines.x2[i], lines.y2[i]);
+            for (size_t j = 0; j < line.size(); j++) {
+                const Point& p = out[offsets[i] + j];
+                if (p.x != line[j].x || p.y != line[j].y)
+                {
+                    mismatches++;
+                    break;
+                }
+            }
+        }
+
+        std::cout << "  " << w.name << ": " << lines.size() << " lines, " << points << " points\n"
+            << "    DDA()      " << lines.size() / scalarTime / 1e6 << " Mlines/s\n"
+            << "    DDABatch() " << lines.size() / batchTime / 1e6 << " Mlines/s ("
+            << scalarTime / batchTime << "x)\n";
+        if (mismatches)
+        {
+            std::cout << "    MISMATCH in " << mismatches << " lines\n";
+        }
+    }
+}
+
+
+// compares every point of two outputs
+static bool SamePixels(const std::vector<Point>& a, const std::vector<Point>& b) {
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef std::vector<Point> (*LineFunction)(float, float, float, float);
+
+// runs fn over all lines on the given number of threads, each thread
+// taking an interleaved share, and returns the points per second
+static double LineThroughput(LineFunction fn, const LineBatch& lines, unsigned threads) {
+    std::vector<size_t> points(threads);
+    std::vector<std::thread> pool;
+    Clock::time_point start = Clock::now();
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            size_t n = 0;
+            for (size_t i = t; i < lines.size(); i += threads) {
+                n += fn(lines.x1[i], lines.y1[i], lines.x2[i], lines.y2[i]).size();
+            }
+            points[t] = n;
+        });
+    }
+    for (std::thread& th : pool) {
+        th.join();
+    }
+    double seconds = SecondsSince(start);
+    size_t total = 0;
+    for (size_t n : points) {
+        total += n;
+    }
+    return total / seconds;
+}
+
+static void BenchLineMath() {
+    LineBatch lines = RandomLines(200000, 1, 1000, false, 7);
+
+    // the integer versions must reproduce their references exactly
+    size_t ddaMismatch = 0, bresMismatch = 0, floatDrift = 0;
+    for (size_t i = 0; i < lines.size(); i++) {
+        float x1 = lines.x1[i], y1 = lines.y1[i], x2 = lines.x2[i], y2 = lines.y2[i];
+        std::vector<Point> reference = DDAReference(x1, y1, x2, y2);
+        ddaMismatch += !SamePixels(DDA<LineMath::Integer>(x1, y1, x2, y2), reference);
+        floatDrift += !SamePixels(DDA<LineMath::Float>(x1, y1, x2, y2), reference);
+        bresMismatch += !SamePixels(Bresenham<LineMath::Integer>(x1, y1, x2, y2), Bresenham<LineMath::Float>(x1, y1, x2, y2));
+    }
+
+    std::cout << "line-math: " << lines.size() << " lines\n"
+        << "  integer DDA vs reference:        " << ddaMismatch << " mismatching lines\n"
+        << "  integer Bresenham vs float:      " << bresMismatch << " mismatching lines\n"
+        << "  float DDA drift from reference:  " << floatDrift << " lines\n";
+
+    // one thread, then enough threads to keep every core's FP and integer units busy
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned threadCounts[] = { 1, cores, cores * 4 };
+    for (unsigned threads : threadCounts) {
+        std::cout << "  " << threads << " thread(s), Mpixels/s\n"
+            << "    DDA<Float>          " << LineThroughput(DDA<LineMath::Float>, lines, threads) / 1e6 << "\n"
+            << "    DDA<Integer>        " << LineThroughput(DDA<LineMath::Integer>, lines, threads) / 1e6 << "\n"
+            << "    Bresenham<Float>    " << LineThroughput(Bresenham<LineMath::Float>, lines, threads) / 1e6 << "\n"
+            << "    Bresenham<Integer>  " << LineThroughput(Bresenham<LineMath::Integer>, lines, threads) / 1e6 << "\n";
+    }
+}
+
+
+static void BenchFilled() {
+    std::cout << "filled\n";
+
+    // what the filled disc used to be: every radius up to r as an outline
+    const float r = 400;
+    Clock::time_point start = Clock::now();
+    size_t points = 0;
+    for (float ri = 0; ri <= r; ri++) {
+        std::vector<Point> ring = MidpointCircle(0, 0, ri);
+        points += ring.size();
+        sink = ring.back().x;
+    }
+    double ringTime = SecondsSince(start);
+
+    start = Clock::now();
+    std::vector<Span> disc = FilledCircle(0, 0, r);
+    double spanTime = SecondsSince(start);
+    sink = disc.back().x2;
+
+    std::cout << "  disc r=" << r << ": " << r + 1 << " circles, " << points << " points, " << ringTime * 1e3 << " ms\n"
+        << "    FilledCircle() " << disc.size() << " spans, " << spanTime * 1e3 << " ms ("
+        << ringTime / spanTime << "x)\n";
+
+    // serial walk against the row parallel closed forms on huge radii
+    JobSystem jobs;
+    unsigned cores = jobs.size();
+    const float radii[] = { 100000, 2000000 };
+    for (float big : radii) {
+        start = Clock::now();
+        std::vector<Span> serial = FilledCircle(0, 0, big);
+        double serialTime = SecondsSince(start);
+        start = Clock::now();
+        std::vector<Span> parallel = FilledCircle(0, 0, big, jobs);
+        double parallelTime = SecondsSince(start);
+        sink = serial.back().x2 + parallel.back().x2;
+        std::cout << "  circle r=" << big << ": serial " << serialTime * 1e3 << " ms, "
+            << cores << " threads " << parallelTime * 1e3 << " ms\n";
+    }
+
+    start = Clock::now();
+    std::vector<Span> serial = FilledEllipse(0, 0, 32768, 20000);
+    double serialTime = SecondsSince(start);
+    start = Clock::now();
+    std::vector<Span> parallel = FilledEllipse(0, 0, 32768, 20000, jobs);
+    double parallelTime = SecondsSince(start);
+    sink = serial.back().x2 + parallel.back().x2;
+    std::cout << "  ellipse 32768x20000: serial " << serialTime * 1e3 << " ms, "
+        << cores << " threads " << parallelTime * 1e3 << " ms\n";
+}
+
+
+// headless pixels per second, to size batch jobs on machines without a GPU
+static void BenchFramebuffer() {
+    LineBatch lines = RandomLines(200000, 1, 1000, false, 11);
+    std::vector<size_t> offsets;
+    std::vector<Point> points(DDABatchOffsets(lines, offsets));
+    DDABatch(lines, offsets.data(), points.data());
+
+    std::vector<Span> discs;
+    for (int i = 0; i < 200; i++) {
+        std::vector<Span> disc = FilledCircle((float)(i * 37 % WIDTH), (float)(i * 91 % HEIGHT), (float)(20 + i % 150));
+        discs.insert(discs.end(), disc.begin(), disc.end());
+    }
+
+    std::cout << "framebuffer: " << points.size() << " points, " << discs.size() << " spans, "
+        << Framebuffer::TILE << "px tiles\n";
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned threadCounts[] = { 1, cores, cores * 2 };
+    for (unsigned threads : threadCounts) {
+        Framebuffer target(WIDTH, HEIGHT, threads);
+        // the first draw sizes the bins
+        target.drawPoints(points.data(), points.size(), 1, 1, 1);
+
+        size_t before = target.pixelsDrawn();
+        Clock::time_point start = Clock::now();
+        target.drawPoints(points.data(), points.size(), 1, 0, 0);
+        double pointTime = SecondsSince(start);
+        size_t pointPixels = target.pixelsDrawn() - before;
+
+        before = target.pixelsDrawn();
+        start = Clock::now();
+        target.drawSpans(discs.data(), discs.size(), 0, 0, 1);
+        double spanTime = SecondsSince(start);
+        size_t spanPixels = target.pixelsDrawn() - before;
+
+        std::cout << "  " << threads << " thread(s): points " << pointPixels / pointTime / 1e6
+            << " Mpixels/s, spans " << spanPixels / spanTime / 1e6 << " Mpixels/s\n";
+    }
+}
+
+
+static void BenchWuLine() {
+    LineBatch lines = RandomLines(200000, 1, 1000, false, 5);
+
+    // written into one preallocated buffer, so only the generator is timed
+    std::vector<size_t> offsets(lines.size() + 1);
+    for (size_t i = 0; i < lines.size(); i++) {
+        offsets[i + 1] = offsets[i] + WuLineCount(lines.x1[i], lines.y1[i], lines.x2[i], lines.y2[i]);
+    }
+    std::vector<CoveragePoint> out(offsets.back());
+
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < lines.size(); i++) {
+        CoverageBufferSink buffer(out.data() + offsets[i]);
+        WuLine(lines.x1[i], lines.y1[i], lines.x2[i], lines.y2[i], buffer);
+    }
+    double bufferTime = SecondsSince(start);
+    sink = out.back().coverage;
+    size_t points = out.size();
+
+    // the vector returning versions, allocation included
+    start = Clock::now();
+    for (size_t i = 0; i < lines.size(); i++) {
+        sink = DDA(lines.x1[i], lines.y1[i], lines.x2[i], lines.y2[i]).back().x;
+    }
+    double ddaTime = SecondsSince(start);
+    start = Clock::now();
+    for (size_t i = 0; i < lines.size(); i++) {
+        sink = WuLine(lines.x1[i], lines.y1[i], lines.x2[i], lines.y2[i]).back().coverage;
+    }
+    double wuTime = SecondsSince(start);
+
+    std::cout << "wu-line: " << lines.size() << " lines, " << points << " pixels\n"
+        << "  into buffer         " << points / bufferTime / 1e6 << " Mpixels/s\n"
+        << "  aliased DDA()       " << lines.size() / ddaTime / 1e6 << " Mlines/s, WuLine() "
+        << lines.size() / wuTime / 1e6 << " Mlines/s\n";
+}
+
+
+// a mixed batch: mostly short lines and small circles, plus a few large
+// shapes that make some ranges far more expensive than others
+static std::vector<Primitive> RandomPrimitives(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(0.0f, (float)WIDTH), offset(-100.0f, 100.0f), radius(1.0f, 100.0f);
+    std::vector<Primitive> batch(n);
+    for (Primitive& p : batch) {
+        float x = std::round(pos(rng)), y = std::round(pos(rng));
+        unsigned kind = rng() % 10;
+        float scale = rng() % 1000 == 0 ? 20.0f : 1.0f;
+        if (kind < 4) p = { PrimitiveType::DDALine, x, y, std::round(x + offset(rng)), std::round(y + offset(rng)) };
+        else if (kind < 7) p = { PrimitiveType::BresenhamLine, x, y, std::round(x + offset(rng)), std::round(y + offset(rng)) };
+        else if (kind < 9) p = { PrimitiveType::Circle, x, y, std::round(radius(rng) * scale), 0 };
+        else p = { PrimitiveType::Ellipse, x, y, std::round(radius(rng) * scale), std::round(radius(rng) * scale) };
+    }
+    return batch;
+}
+
+static void BenchJobBatch() {
+    std::vector<Primitive> batch = RandomPrimitives(1000000, 9);
+
+    // what main.cpp used to do: one primitive after the other on one thread
+    Clock::time_point start = Clock::now();
+    std::vector<size_t> serialOffsets(batch.size() + 1);
+    for (size_t i = 0; i < batch.size(); i++) {
+        serialOffsets[i + 1] = serialOffsets[i] + PrimitiveCount(batch[i]);
+    }
+    double serialTime = SecondsSince(start);
+
+    // the output is allocated outside the timing here and below, like the GL buffer would be
+    std::vector<Point> serial(serialOffsets.back());
+    start = Clock::now();
+    for (size_t i = 0; i < batch.size(); i++) {
+        GeneratePrimitive(batch[i], serial.data() + serialOffsets[i]);
+    }
+    serialTime += SecondsSince(start);
+
+    std::cout << "job-batch: " << batch.size() << " primitives, " << serial.size() << " points, "
+        << std::thread::hardware_concurrency() << " hardware threads\n"
+        << "  serial        " << serialTime * 1e3 << " ms, " << serial.size() / serialTime / 1e6 << " Mpoints/s\n";
+
+    const unsigned threadCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+    for (unsigned threads : threadCounts) {
+        JobSystem jobs(threads);
+        std::vector<size_t> offsets;
+        start = Clock::now();
+        size_t total = BatchOffsets(batch, offsets, jobs);
+        double countTime = SecondsSince(start);
+
+        std::vector<Point> out(total);
+        start = Clock::now();
+        GenerateBatch(batch, offsets.data(), out.data(), jobs);
+        double generateTime = SecondsSince(start);
+
+        bool same = offsets == serialOffsets;
+        for (size_t i = 0; same && i < out.size(); i++) {
+            same = out[i].x == serial[i].x && out[i].y == serial[i].y;
+        }
+
+        double seconds = countTime + generateTime;
+        std::cout << "  " << threads << " thread(s)  count+scan " << countTime * 1e3 << " ms, generate "
+            << generateTime * 1e3 << " ms, " << total / seconds / 1e6 << " Mpoints/s ("
+            << serialTime / seconds << "x serial)" << (same ? "" : " MISMATCH") << "\n";
+    }
+}
+
+
+static bool SamePrimitives(const Primitive* a, const std::vector<Primitive>& b, size_t n) {
+    if (n != b.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (a[i].type != b[i].type || a[i].x1 != b[i].x1 || a[i].y1 != b[i].y1 || a[i].x2 != b[i].x2 || a[i].y2 != b[i].y2) return false;
+    }
+    return true;
+}
+
+static void BenchLoad() {
+    std::vector<Primitive> batch = RandomPrimitives(2000000, 12);
+    const char* textPath = "bench_primitives.txt";
+    const char* binaryPath = "bench_primitives.l2p";
+    if (!SavePrimitivesText(textPath, batch.data(), batch.size()) || !SavePrimitivesBinary(binaryPath, batch.data(), batch.size()))
+    {
+        std::cout << "load: could not write the test files\n";
+        return;
+    }
+    std::cout << "load: " << batch.size() << " primitives\n";
+
+    // what GetInput() style reading costs: iostream extraction word by word
+    Clock::time_point start = Clock::now();
+    std::vector<Primitive> streamed;
+    {
+        std::ifstream in(textPath);
+        std::string word;
+        Primitive p = {};
+        while (in >> word) {
+            bool circle = word == "circle";
+            p.type = word == "dda" ? PrimitiveType::DDALine : word == "bresenham" ? PrimitiveType::BresenhamLine
+                : circle ? PrimitiveType::Circle : PrimitiveType::Ellipse;
+            in >> p.x1 >> p.y1 >> p.x2;
+            p.y2 = 0;
+            if (!circle) in >> p.y2;
+            streamed.push_back(p);
+        }
+    }
+    double streamTime = SecondsSince(start);
+
+    JobSystem jobs;
+    std::vector<size_t> offsets;
+    auto report = [&](const char* name, const char* path) {
+        PrimitiveFile file;
+        Clock::time_point start = Clock::now();
+        bool ok = file.open(path);
+        double loadTime = SecondsSince(start);
+        // the binary file is only mapped by open(), the first pass over it pays for the reads
+        size_t points = ok ? BatchOffsets(file.data(), file.size(), offsets, jobs) : 0;
+        double countTime = SecondsSince(start);
+        std::cout << "  " << name << file.bytes() / 1e6 << " MB, open " << loadTime * 1e3 << " ms ("
+            << file.bytes() / loadTime / 1e6 << " MB/s), open+count " << countTime * 1e3 << " ms ("
+            << file.bytes() / countTime / 1e6 << " MB/s), " << points << " points"
+            << (ok && SamePrimitives(file.data(), batch, file.size()) ? "" : " MISMATCH") << "\n";
+    };
+
+    MappedFile text;
+    text.open(textPath);
+    std::cout << "  iostream text " << text.size() / 1e6 << " MB, " << streamTime * 1e3 << " ms ("
+        << text.size() / streamTime / 1e6 << " MB/s)" << (SamePrimitives(streamed.data(), batch, streamed.size()) ? "" : " MISMATCH") << "\n";
+    text.close();
+    report("from_chars text ", textPath);
+    report("mapped binary   ", binaryPath);
+
+    std::remove(textPath);
+    std::remove(binaryPath);
+}
+
+
+static void BenchCurves() {
+    const size_t n = 100000;
+    const int SEGMENTS = 16;
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> pos(0.0f, (float)WIDTH);
+    std::vector<float> control(n * 8);
+    for (float& c : control) c = std::round(pos(rng));
+    std::vector<uint32_t> pixels((size_t)WIDTH * HEIGHT);
+    PlotSink plot{ pixels.data(), WIDTH, HEIGHT, 0xFFFFFFFFu };
+
+    // what the offline flattening does: a fixed polyline per curve, one Bresenham() per segment
+    auto flatten = [&](const float* c, auto& out) {
+        float px = c[0], py = c[1];
+        for (int s = 1; s <= SEGMENTS; s++) {
+            float t = (float)s / SEGMENTS, u = 1 - t;
+            float x = std::round(u * u * u * c[0] + 3 * u * u * t * c[2] + 3 * u * t * t * c[4] + t * t * t * c[6]);
+            float y = std::round(u * u * u * c[1] + 3 * u * u * t * c[3] + 3 * u * t * t * c[5] + t * t * t * c[7]);
+            Bresenham(px, py, x, y, out);
+            px = x, py = y;
+        }
+    };
+
+    // both plot the same curves into the framebuffer
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < n; i++) {
+        flatten(&control[i * 8], plot);
+    }
+    double flatTime = SecondsSince(start);
+
+    start = Clock::now();
+    for (size_t i = 0; i < n; i++) {
+        const float* c = &control[i * 8];
+        CubicBezier(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], plot);
+    }
+    double curveTime = SecondsSince(start);
+    sink = pixels[pixels.size() / 2];
+
+    // pixel counts, outside the timing
+    CountingSink flatPixels, curvePixels;
+    for (size_t i = 0; i < n; i++) {
+        const float* c = &control[i * 8];
+        flatten(c, flatPixels);
+        CubicBezier(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], curvePixels);
+    }
+
+    std::cout << "curves: " << n << " random cubic Beziers plotted\n"
+        << "  " << SEGMENTS << " Bresenham segments " << flatTime * 1e3 << " ms, " << flatPixels.count << " pixels ("
+        << flatPixels.count - curvePixels.count << " more), " << flatPixels.count / flatTime / 1e6 << " Mpixels/s\n"
+        << "  CubicBezier()        " << curveTime * 1e3 << " ms, " << curvePixels.count << " pixels, "
+        << curvePixels.count / curveTime / 1e6 << " Mpixels/s (" << flatTime / curveTime << "x)\n";
+}
+
+
+// what a ray march without a traversal does: a sample every half voxel,
+// counting a voxel whenever the sample lands in a new one. It can cut
+// across the corner of a voxel the segment only grazes.
+template <typename Visit>
+static bool SampledVoxelWalk(float x0, float y0, float z0, float x1, float y1, float z1, Visit visit) {
+    float dx = x1 - x0, dy = y1 - y0, dz = z1 - z0;
+    int samples = (int)std::ceil(std::sqrt(dx * dx + dy * dy + dz * dz) * 2) + 1;
+    int px = INT32_MIN, py = 0, pz = 0;
+    for (int i = 0; i < samples; i++) {
+        float t = samples > 1 ? (float)i / (samples - 1) : 0;
+        int x = (int)std::floor(x0 + dx * t), y = (int)std::floor(y0 + dy * t), z = (int)std::floor(z0 + dz * t);
+        if (x != px || y != py || z != pz)
+        {
+            if (!visit(x, y, z))
+            {
+                return false;
+            }
+            px = x, py = y, pz = z;
+        }
+    }
+    return true;
+}
+
+static void BenchVoxels() {
+    struct Workload { int size; size_t rays; int emptyRun; };
+    const Workload workloads[] = {
+        { 256, 200000, 64 },
+        { 1024, 50000, 256 },
+    };
+
+    std::cout << "voxels (" << SimdISA() << ", " << SimdD::LANES << " rays per group)\n";
+    for (const Workload& w : workloads) {
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> pos(0.0f, (float)w.size);
+        RayBatch rays;
+        for (size_t i = 0; i < w.rays; i++) {
+            rays.add(pos(rng), pos(rng), pos(rng), pos(rng), pos(rng), pos(rng));
+        }
+        // on average one occupied voxel every emptyRun voxels
+        OccupancyGrid grid(w.size);
+        size_t voxels = (size_t)w.size * w.size * w.size;
+        std::uniform_int_distribution<int> cell(0, w.size - 1);
+        for (size_t i = 0; i < voxels / w.emptyRun; i++) {
+            grid.set(cell(rng), cell(rng), cell(rng));
+        }
+        std::cout << "  " << w.size << "^3: " << rays.size() << " rays\n";
+
+        // every voxel of every ray
+        Clock::time_point start = Clock::now();
+        size_t sampled = 0;
+        for (size_t i = 0; i < rays.size(); i++) {
+            SampledVoxelWalk(rays.x0[i], rays.y0[i], rays.z0[i], rays.x1[i], rays.y1[i], rays.z1[i],
+                [&](int, int, int) { sampled++; return true; });
+        }
+        double sampledTime = SecondsSince(start);
+
+        start = Clock::now();
+        size_t walked = 0;
+        for (size_t i = 0; i < rays.size(); i++) {
+            TraverseVoxels(rays.x0[i], rays.y0[i], rays.z0[i], rays.x1[i], rays.y1[i], rays.z1[i],
+                [&](int, int, int) { walked++; return true; });
+        }
+        double walkTime = SecondsSince(start);
+
+        start = Clock::now();
+        size_t batched = 0;
+        TraverseVoxelBatch(rays, [&](size_t, int, int, int) { batched++; return true; });
+        double batchTime = SecondsSince(start);
+
+        // the buffer version has to reproduce the scalar walk exactly
+        std::vector<size_t> offsets;
+        std::vector<Voxel> out(VoxelBatchOffsets(rays, offsets));
+        VoxelBatch(rays, offsets.data(), out.data());
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < rays.size(); i++) {
+            size_t j = offsets[i];
+            TraverseVoxels(rays.x0[i], rays.y0[i], rays.z0[i], rays.x1[i], rays.y1[i], rays.z1[i], [&](int x, int y, int z) {
+                bool same = out[j].x == x && out[j].y == y && out[j].z == z;
+                j++;
+                mismatches += !same;
+                return same;
+            });
+        }
+
+        std::cout << "    walk, Mvoxels/s\n"
+            << "      sampled         " << sampled / sampledTime / 1e6 << " (" << walked - sampled << " voxels missed)\n"
+            << "      TraverseVoxels  " << walked / walkTime / 1e6 << " (" << sampledTime / walkTime << "x)\n"
+            << "      batch           " << batched / batchTime / 1e6 << " (" << sampledTime / batchTime << "x)\n";
+        if (mismatches)
+        {
+            std::cout << "      MISMATCH in " << mismatches << " rays\n";
+        }
+
+        // first occupied voxel, the walk stops there
+        std::vector<Voxel> sampledHits(rays.size(), Voxel{ -1, -1, -1 });
+        start = Clock::now();
+        for (size_t i = 0; i < rays.size(); i++) {
+            SampledVoxelWalk(rays.x0[i], rays.y0[i], rays.z0[i], rays.x1[i], rays.y1[i], rays.z1[i], [&](int x, int y, int z) {
+                bool hit = grid.occupied(x, y, z);
+                if (hit) sampledHits[i] = { x, y, z };
+                return !hit;
+            });
+        }
+        sampledTime = SecondsSince(start);
+
+        std::vector<Voxel> hits(rays.size(), Voxel{ -1, -1, -1 });
+        start = Clock::now();
+        for (size_t i = 0; i < rays.size(); i++) {
+            Voxel hit;
+            if (FirstOccupied(grid, rays.x0[i], rays.y0[i], rays.z0[i], rays.x1[i], rays.y1[i], rays.z1[i], hit))
+            {
+                hits[i] = hit;
+            }
+        }
+        walkTime = SecondsSince(start);
+
+        std::vector<Voxel> batchHits(rays.size(), Voxel{ -1, -1, -1 });
+        start = Clock::now();
+        TraverseVoxelBatch(rays, [&](size_t ray, int x, int y, int z) {
+            bool hit = grid.occupied(x, y, z);
+            if (hit) batchHits[ray] = { x, y, z };
+            return !hit;
+        });
+        batchTime = SecondsSince(start);
+
+        size_t sampledWrong = 0, batchWrong = 0, found = 0;
+        for (size_t i = 0; i < rays.size(); i++) {
+            auto same = [](const Voxel& a, const Voxel& b) { return a.x == b.x && a.y == b.y && a.z == b.z; };
+            found += hits[i].x >= 0;
+            sampledWrong += !same(sampledHits[i], hits[i]);
+            batchWrong += !same(batchHits[i], hits[i]);
+        }
+
+        std::cout << "    first occupied voxel, " << found << " rays hit, Mrays/s\n"
+            << "      sampled         " << rays.size() / sampledTime / 1e6 << " (" << sampledWrong << " rays with another hit)\n"
+            << "      FirstOccupied   " << rays.size() / walkTime / 1e6 << " (" << sampledTime / walkTime << "x)\n"
+            << "      batch           " << rays.size() / batchTime / 1e6 << " (" << sampledTime / batchTime << "x)\n";
+        if (batchWrong)
+        {
+            std::cout << "      MISMATCH in " << batchWrong << " rays\n";
+        }
+    }
+}
+
+
+// scanline fill without the edge table: every row intersects every edge
+// and sorts the crossings, so the cost is rows * edges
+static void NaivePolygonFill(const std::vector<Point>& v, FillRule rule, PlotSink& sink) {
+    std::vector<std::pair<double, int>> crossings;
+    for (int y = 0; y < sink.height; y++) {
+        double cy = y + 0.5;
+        crossings.clear();
+        for (size_t i = 0; i < v.size(); i++) {
+            Point a = v[i], b = v[(i + 1) % v.size()];
+            if ((a.y <= cy && cy < b.y) || (b.y <= cy && cy < a.y))
+            {
+                crossings.push_back({ a.x + (double)(b.x - a.x) * (cy - a.y) / (b.y - a.y), b.y > a.y ? 1 : -1 });
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+        int winding = 0;
+        for (size_t i = 0; i + 1 < crossings.size(); i++) {
+            winding += rule == FillRule::EvenOdd ? 1 : crossings[i].second;
+            bool inside = rule == FillRule::EvenOdd ? (winding & 1) != 0 : winding != 0;
+            double left = std::ceil(crossings[i].first - 0.5), right = std::ceil(crossings[i + 1].first - 0.5) - 1;
+            if (inside && left <= right)
+            {
+                sink.put(Span{ (float)left, (float)y, (float)right, (float)y });
+            }
+        }
+    }
+}
+
+static void BenchPolygon() {
+    const size_t n = 100000;
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    auto around = [&](float radius, float jitter) {
+        std::vector<Point> v(n);
+        for (size_t i = 0; i < n; i++) {
+            float a = 6.2831853f * i / n, r = radius * (1 - jitter * unit(rng));
+            v[i] = { 500 + r * std::cos(a), 500 + r * std::sin(a) };
+        }
+        return v;
+    };
+    struct Workload { const char* name; std::vector<Point> vertices; };
+    std::vector<Workload> workloads;
+    workloads.push_back({ "outline", around(480, 0.02f) });   // concave detail, few crossings per row
+    workloads.push_back({ "star", around(480, 0.9f) });       // deep spikes, many crossings per row
+    std::vector<Point> tangle(n);
+    for (Point& p : tangle) p = { unit(rng) * WIDTH, unit(rng) * HEIGHT };
+    workloads.push_back({ "tangle", tangle });                // random vertices, crosses itself everywhere
+
+    std::cout << "polygon: " << n << " vertices, " << WIDTH << "x" << HEIGHT << " (" << SimdISA() << " span fill)\n";
+    std::vector<uint32_t> pixels((size_t)WIDTH * HEIGHT), reference((size_t)WIDTH * HEIGHT);
+    Framebuffer target(WIDTH, HEIGHT);
+    const FillRule rules[] = { FillRule::EvenOdd, FillRule::NonZero };
+    for (const Workload& w : workloads) {
+        for (FillRule rule : rules) {
+            std::fill(reference.begin(), reference.end(), 0u);
+            PlotSink naive{ reference.data(), WIDTH, HEIGHT, 0xFFFFFFFFu };
+            Clock::time_point start = Clock::now();
+            NaivePolygonFill(w.vertices, rule, naive);
+            double naiveTime = SecondsSince(start);
+
+            start = Clock::now();
+            std::vector<Span> spans = FillPolygon(w.vertices, rule);
+            double spanTime = SecondsSince(start);
+
+            std::fill(pixels.begin(), pixels.end(), 0u);
+            start = Clock::now();
+            EdgeTable table(w.vertices.data(), w.vertices.size());
+            PlotSink plot{ pixels.data(), WIDTH, HEIGHT, 0xFFFFFFFFu };
+            table.scan(0, HEIGHT, rule, plot);
+            double plotTime = SecondsSince(start);
+
+            target.clear(0, 0, 0);
+            start = Clock::now();
+            target.fillPolygon(w.vertices.data(), w.vertices.size(), rule, 1, 1, 1);
+            double tileTime = SecondsSince(start);
+
+            size_t filled = 0, differ = 0, tileDiffer = 0;
+            for (int y = 0; y < HEIGHT; y++) {
+                for (int x = 0; x < WIDTH; x++) {
+                    uint32_t p = pixels[(size_t)y * WIDTH + x];
+                    filled += p != 0;
+                    differ += p != reference[(size_t)y * WIDTH + x];
+                    tileDiffer += (p != 0) != (target.pixel(x, y) == 0xFFFFFFFFu);
+                }
+            }
+
+            std::cout << "  " << w.name << (rule == FillRule::EvenOdd ? " even-odd" : " nonzero") << ": "
+                << table.size() << " edges, " << spans.size() << " spans, " << filled << " pixels\n"
+                << "    per-row intersections " << naiveTime * 1e3 << " ms\n"
+                << "    FillPolygon() spans   " << spanTime * 1e3 << " ms (" << naiveTime / spanTime << "x)\n"
+                << "    edge table to pixels  " << plotTime * 1e3 << " ms (" << naiveTime / plotTime << "x)\n"
+                << "    Framebuffer, " << target.height() / Framebuffer::TILE + 1 << " bands " << tileTime * 1e3 << " ms ("
+                << naiveTime / tileTime << "x)\n";
+            if (differ || tileDiffer)
+            {
+                std::cout << "    MISMATCH in " << differ << " pixels, " << tileDiffer << " in the framebuffer\n";
+            }
+        }
+    }
+}
+
+
+// what a fill without spans does: one queue entry per pixel, four neighbours each
+static size_t PixelQueueFill(uint32_t* pixels, int width, int height, int x, int y, uint32_t boundary, uint32_t color) {
+    std::vector<size_t> queue = { (size_t)y * width + x };
+    pixels[queue[0]] = color;
+    for (size_t head = 0; head < queue.size(); head++) {
+        size_t i = queue[head];
+        int px = (int)(i % width), py = (int)(i / width);
+        const int dx[4] = { -1, 1, 0, 0 }, dy[4] = { 0, 0, -1, 1 };
+        for (int k = 0; k < 4; k++) {
+            int nx = px + dx[k], ny = py + dy[k];
+            if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+            {
+                continue;
+            }
+            uint32_t& p = pixels[(size_t)ny * width + nx];
+            if (p != boundary && p != color)
+            {
+                p = color;
+                queue.push_back((size_t)ny * width + nx);
+            }
+        }
+    }
+    return queue.size();
+}
+
+static void BenchRegionFill() {
+    struct Canvas { const char* name; int width, height; };
+    const Canvas canvases[] = { { "4K", 3840, 2160 }, { "8K", 7680, 4320 } };
+    const uint32_t WALL = 0xFFFFFFFFu, FILL = 0xFF0000FFu;
+    JobSystem jobs;
+
+    std::cout << "fill (" << jobs.size() << " workers, bands of " << FILL_BAND << " rows)\n";
+    for (const Canvas& c : canvases) {
+        // one big ellipse with random circles inside as walls, the fill runs between them
+        std::vector<uint32_t> scene((size_t)c.width * c.height, 0xFF000000u);
+        BitMask walls(c.width, c.height);
+        PlotSink plot{ scene.data(), c.width, c.height, WALL };
+        MaskSink mask{ walls };
+        float cx = c.width / 2.0f, cy = c.height / 2.0f;
+        MidpointEllipse(cx, cy, cx - 2, cy - 2, plot);
+        MidpointEllipse(cx, cy, cx - 2, cy - 2, mask);
+        std::mt19937 rng(17);
+        std::uniform_real_distribution<float> px(0, (float)c.width), py(0, (float)c.height), radius(4, c.height / 24.0f);
+        for (int i = 0; i < 500; i++) {
+            float x = std::round(px(rng)), y = std::round(py(rng)), r = std::round(radius(rng));
+            if (std::hypot(x - cx, y - cy) < r + 4) continue;   // keep the seed outside
+            MidpointCircle(x, y, r, plot);
+            MidpointCircle(x, y, r, mask);
+        }
+        int seedX = (int)cx, seedY = (int)cy;
+
+        std::vector<uint32_t> reference = scene, pixels;
+        Clock::time_point start = Clock::now();
+        size_t queued = PixelQueueFill(reference.data(), c.width, c.height, seedX, seedY, WALL, FILL);
+        double queueTime = SecondsSince(start);
+
+        auto run = [&](const char* name, const std::function<size_t()>& fill, bool rgba) {
+            pixels = scene;
+            BitMask before = walls;
+            Clock::time_point start = Clock::now();
+            size_t filled = fill();
+            double time = SecondsSince(start);
+            bool same = filled == queued && (!rgba || pixels == reference);
+            std::cout << "    " << name << time * 1e3 << " ms (" << queueTime / time << "x)"
+                << (same ? "" : "  MISMATCH") << "\n";
+            walls = before;
+        };
+
+        std::cout << "  " << c.name << " " << c.width << "x" << c.height << ": " << queued << " pixels\n"
+            << "    pixel queue           " << queueTime * 1e3 << " ms\n";
+        run("BoundaryFill() RGBA    ", [&] { return BoundaryFill(pixels.data(), c.width, c.height, seedX, seedY, WALL, FILL); }, true);
+        run("FloodFill() bit mask   ", [&] { NullSpanSink none; return FloodFill(walls, seedX, seedY, none); }, false);
+        run("banded BoundaryFill()  ", [&] { return BoundaryFill(pixels.data(), c.width, c.height, seedX, seedY, WALL, FILL, jobs); }, true);
+        run("banded FloodFill() mask ", [&] { return FloodFill(walls, seedX, seedY, jobs); }, false);
+    }
+}
+
+// far-off input: lines from well outside the window through it or past it,
+// and huge circles and ellipses of which only an arc or nothing is visible
+static void BenchClip() {
+    const float far = 50000;
+    std::mt19937 rng(19);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f), screen(0.0f, (float)WIDTH), unit(0.0f, 1.0f);
+    std::vector<Primitive> batch;
+    for (int i = 0; i < 200; i++) {
+        // from a far point through a random pixel (every other one misses) to the other side
+        float a = angle(rng), sx = screen(rng), sy = screen(rng);
+        if (i % 2) sx += 3 * WIDTH;
+        float x1 = std::round(WIDTH / 2 + far * std::cos(a)), y1 = std::round(HEIGHT / 2 + far * std::sin(a));
+        float x2 = std::round(2 * sx - x1), y2 = std::round(2 * sy - y1);
+        batch.push_back({ i % 4 < 2 ? PrimitiveType::DDALine : PrimitiveType::BresenhamLine, x1, y1, x2, y2 });
+    }
+    for (int i = 0; i < 20; i++) {
+        // centred far away with the rim passing near the window
+        float a = angle(rng), d = far * (0.2f + 0.8f * unit(rng));
+        float xc = std::round(WIDTH / 2 + d * std::cos(a)), yc = std::round(HEIGHT / 2 + d * std::sin(a));
+        float r = std::round(d + WIDTH * (unit(rng) - 0.5f));
+        batch.push_back({ i % 2 ? PrimitiveType::Ellipse : PrimitiveType::Circle, xc, yc, r, std::round(r * 0.9f) });
+    }
+
+    const Viewport& view = SCREEN_VIEWPORT;
+    std::vector<size_t> offsets(batch.size() + 1), clippedOffsets(batch.size() + 1);
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < batch.size(); i++) {
+        offsets[i + 1] = offsets[i] + PrimitiveCount(batch[i]);
+    }
+    std::vector<Point> points(offsets.back());
+    for (size_t i = 0; i < batch.size(); i++) {
+        GeneratePrimitive(batch[i], points.data() + offsets[i]);
+    }
+    double fullTime = SecondsSince(start);
+
+    start = Clock::now();
+    for (size_t i = 0; i < batch.size(); i++) {
+        clippedOffsets[i + 1] = clippedOffsets[i] + PrimitiveCount(batch[i], view);
+    }
+    std::vector<Point> clipped(clippedOffsets.back());
+    for (size_t i = 0; i < batch.size(); i++) {
+        GeneratePrimitive(batch[i], view, clipped.data() + clippedOffsets[i]);
+    }
+    double clipTime = SecondsSince(start);
+
+    // the clipped points must be the visible ones of the full walk, in order
+    size_t mismatches = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+        std::vector<Point> visible;
+        for (size_t j = offsets[i]; j < offsets[i + 1]; j++) {
+            if (view.contains(points[j].x, points[j].y)) visible.push_back(points[j]);
+        }
+        std::vector<Point> own(clipped.begin() + clippedOffsets[i], clipped.begin() + clippedOffsets[i + 1]);
+        mismatches += !SamePixels(visible, own);
+    }
+
+    std::cout << "clip: " << batch.size() << " far-off primitives, " << WIDTH << "x" << HEIGHT << " viewport\n"
+        << "  unclipped " << points.size() << " points, " << points.size() * sizeof(Point) / 1e6 << " MB, " << fullTime * 1e3 << " ms\n"
+        << "  clipped   " << clipped.size() << " points, " << clipped.size() * sizeof(Point) / 1e6 << " MB, " << clipTime * 1e3
+        << " ms (" << fullTime / clipTime << "x)" << (mismatches ? "  MISMATCH" : "") << "\n";
+
+    // the float DDA reaches the view through its sums one binade at a time,
+    // the rest jump straight to it
+    const PrimitiveType types[] = { PrimitiveType::DDALine, PrimitiveType::BresenhamLine };
+    for (PrimitiveType type : types) {
+        std::vector<Primitive> lines;
+        for (const Primitive& p : batch) {
+            if (p.type == type) lines.push_back(p);
+        }
+        auto time = [&](const std::function<size_t(float, float, float, float)>& count) {
+            size_t total = 0;
+            Clock::time_point start = Clock::now();
+            for (const Primitive& p : lines) total += count(p.x1, p.y1, p.x2, p.y2);
+            sink = (float)total;
+            return SecondsSince(start) * 1e6 / lines.size();
+        };
+        const char* name = type == PrimitiveType::DDALine ? "DDA" : "Bresenham";
+        double floatTime = time([&](float x1, float y1, float x2, float y2) {
+            CountingSink c;
+            type == PrimitiveType::DDALine ? DDA(x1, y1, x2, y2, view, c) : Bresenham(x1, y1, x2, y2, view, c);
+            return c.count;
+        });
+        double intTime = time([&](float x1, float y1, float x2, float y2) {
+            CountingSink c;
+            type == PrimitiveType::DDALine ? DDA<LineMath::Integer>(x1, y1, x2, y2, view, c) : Bresenham<LineMath::Integer>(x1, y1, x2, y2, view, c);
+            return c.count;
+        });
+        std::cout << "  clipped " << name << " per line: float " << floatTime << " us, integer " << intTime << " us\n";
+    }
+}
+
+
+// one huge primitive of each kind, materialized in full against streamed
+// through a fixed chunk that is copied out whenever it fills up
+static void BenchStream() {
+    struct Shape { const char* name; std::function<std::vector<Point>()> full; std::function<PointGenerator()> lazy; };
+    const Shape shapes[] = {
+        { "DDA 10^7", [] { return DDA(0, 0, 1e7f, 3e6f); }, [] { return StreamDDA(0, 0, 1e7f, 3e6f); } },
+        { "Bresenham 10^7", [] { return Bresenham(0, 0, 3e6f, 1e7f); }, [] { return StreamBresenham(0, 0, 3e6f, 1e7f); } },
+        { "circle r 10^6", [] { return MidpointCircle(500, 500, 1e6f); }, [] { return StreamMidpointCircle(500, 500, 1e6f); } },
+        { "ellipse 10^6", [] { return MidpointEllipse(500, 500, 1e6f, 6e5f); }, [] { return StreamMidpointEllipse(500, 500, 1e6f, 6e5f); } },
+    };
+    const size_t capacity = UPLOAD_RING_BYTES / sizeof(Point);
+    std::vector<Point> chunk(capacity), upload(capacity);
+
+    std::cout << "stream: " << UPLOAD_RING_BYTES / 1024 << " KB chunk\n";
+    for (const Shape& shape : shapes) {
+        Clock::time_point start = Clock::now();
+        std::vector<Point> full = shape.full();
+        // the upload a materialized primitive needs, a copy of all of it
+        std::vector<Point> copy(full);
+        double fullTime = SecondsSince(start);
+
+        start = Clock::now();
+        PointGenerator points = shape.lazy();
+        size_t streamed = StreamChunks(points, chunk.data(), capacity, [&](const Point* p, size_t n) {
+            std::copy(p, p + n, upload.begin());
+        });
+        double streamTime = SecondsSince(start);
+
+        // same points in the same order
+        PointGenerator check = shape.lazy();
+        size_t at = 0;
+        bool same = true;
+        StreamChunks(check, chunk.data(), capacity, [&](const Point* p, size_t n) {
+            for (size_t i = 0; i < n && same; i++, at++) {
+                same = at < full.size() && p[i].x == full[at].x && p[i].y == full[at].y;
+            }
+        });
+        same = same && at == full.size() && streamed == full.size();
+
+        std::cout << "  " << shape.name << ": " << full.size() << " points\n"
+            << "    materialized " << 2 * full.size() * sizeof(Point) / 1e6 << " MB, " << fullTime * 1e3 << " ms\n"
+            << "    streamed     " << 2 * UPLOAD_RING_BYTES / 1e6 << " MB, " << streamTime * 1e3 << " ms"
+            << (same ? "" : "  MISMATCH") << "\n";
+    }
+}
+
+static void BenchShapeCache() {
+    // 10k circles and ellipses, a few sizes shared by many of them
+    struct Workload { const char* name; int sizes; size_t maxBytes; };
+    const Workload workloads[] = {
+        { "16 sizes", 16, SHAPE_CACHE_BYTES },
+        { "4096 sizes, 1 MB cap", 4096, 1 << 20 },
+    };
+    const size_t count = 10000;
+    JobSystem jobs(std::thread::hardware_concurrency());
+
+    std::cout << "shape-cache: " << count << " circles and ellipses\n";
+    for (const Workload& w : workloads) {
+        std::mt19937 random(11);
+        std::uniform_real_distribution<float> coordinate(0, 1000);
+        std::uniform_int_distribution<int> pick(0, w.sizes - 1);
+        std::vector<Primitive> batch;
+        for (size_t i = 0; i < count; i++) {
+            float r = 5 + 195.0f * pick(random) / w.sizes;
+            batch.push_back(i % 2 ? Primitive{ PrimitiveType::Circle, coordinate(random), coordinate(random), r, 0 }
+                : Primitive{ PrimitiveType::Ellipse, coordinate(random), coordinate(random), r, r / 2 });
+        }
+        std::vector<size_t> offsets;
+        size_t total = BatchOffsets(batch, offsets, jobs);
+        std::vector<Point> walked(total), cached(total);
+
+        Clock::time_point start = Clock::now();
+        GenerateBatch(batch, offsets.data(), walked.data(), jobs);
+        double walkTime = SecondsSince(start);
+
+        ShapeCache cache(w.maxBytes);
+        start = Clock::now();
+        GenerateBatch(batch, cache, offsets.data(), cached.data(), jobs);
+        double cacheTime = SecondsSince(start);
+        ShapeCache::Stats stats = cache.stats();
+
+        bool same = true;
+        for (size_t i = 0; i < total && same; i++) {
+            same = walked[i].x == cached[i].x && walked[i].y == cached[i].y;
+        }
+        std::cout << "  " << w.name << ": " << total << " points\n"
+            << "    walked " << walkTime * 1e3 << " ms\n"
+            << "    cached " << cacheTime * 1e3 << " ms, " << stats.hitRate() * 100 << "% hits, " << stats.entries << " shapes, "
+            << stats.bytes / 1024 << " KB, " << stats.evictions << " evictions" << (same ? "" : "  MISMATCH") << "\n";
+    }
+}
+
+static void BenchPacked() {
+    // a screen of random primitives generated as float and as int16 positions
+    std::mt19937 random(13);
+    std::uniform_real_distribution<float> coordinate(0, 1000), size(1, 300);
+    std::vector<Primitive> batch;
+    for (size_t i = 0; i < 20000; i++) {
+        PrimitiveType type = (PrimitiveType)(i % 4);
+        bool line = type == PrimitiveType::DDALine || type == PrimitiveType::BresenhamLine;
+        batch.push_back({ type, coordinate(random), coordinate(random), line ? coordinate(random) : size(random), size(random) });
+    }
+    JobSystem jobs(std::thread::hardware_concurrency());
+    std::vector<size_t> offsets;
+    size_t total = BatchOffsets(batch, SCREEN_VIEWPORT, offsets, jobs);
+    std::vector<Point> floats(total);
+    std::vector<PackedPoint> packed(total);
+
+    Clock::time_point start = Clock::now();
+    GenerateBatch(batch, SCREEN_VIEWPORT, offsets.data(), floats.data(), jobs);
+    double floatTime = SecondsSince(start);
+    start = Clock::now();
+    GenerateBatch(batch, SCREEN_VIEWPORT, offsets.data(), packed.data(), jobs);
+    double packedTime = SecondsSince(start);
+
+    bool same = true;
+    for (size_t i = 0; i < total && same; i++) {
+        same = packed[i].x == PackCoordinate(floats[i].x) && packed[i].y == PackCoordinate(floats[i].y);
+    }
+    std::cout << "packed: " << batch.size() << " primitives, " << total << " points\n"
+        << "  float " << total * sizeof(Point) / 1e6 << " MB, " << floatTime * 1e3 << " ms\n"
+        << "  int16 " << total * sizeof(PackedPoint) / 1e6 << " MB, " << packedTime * 1e3 << " ms"
+        << (same ? "" : "  MISMATCH") << "\n";
+}
+
+static void BenchOccupancy() {
+    // overlapping primitives in a few colors, as point lists and as masks
+    const size_t counts[] = { 2000, 20000 };
+    JobSystem jobs(std::thread::hardware_concurrency());
+    const Viewport clip = { -0.5f, -0.5f, WIDTH + 0.5f, HEIGHT + 0.5f };
+
+    std::cout << "occupancy: 4 colors\n";
+    for (size_t count : counts) {
+        std::mt19937 random(17);
+        std::uniform_real_distribution<float> coordinate(0, 1000), size(1, 300);
+        std::vector<Primitive> batch;
+        OccupancyLayers layers;
+        for (size_t i = 0; i < count; i++) {
+            PrimitiveType type = (PrimitiveType)(i % 4);
+            bool line = type == PrimitiveType::DDALine || type == PrimitiveType::BresenhamLine;
+            batch.push_back({ type, coordinate(random), coordinate(random), line ? coordinate(random) : size(random), size(random) });
+            layers.add(batch.back(), (float)(i / 4 % 4 == 0), (float)(i / 4 % 4 == 1), (float)(i / 4 % 4 == 2));
+        }
+
+        // the point lists a store uploads
+        Clock::time_point start = Clock::now();
+        std::vector<size_t> offsets;
+        size_t total = BatchOffsets(batch, clip, offsets, jobs);
+        std::vector<PackedPoint> listed(total);
+        GenerateBatch(batch, clip, offsets.data(), listed.data(), jobs);
+        double listTime = SecondsSince(start);
+
+        start = Clock::now();
+        layers.rasterize(jobs);
+        size_t unique = 0;
+        for (size_t i = 0; i < layers.layers(); i++) unique += layers.unique(i);
+        std::vector<PackedPoint> compacted(unique);
+        for (size_t i = 0, at = 0; i < layers.layers(); i++) at += layers.compact(i, compacted.data() + at, jobs);
+        double maskTime = SecondsSince(start);
+
+        // every layer holds exactly the distinct on-screen pixels of its primitives
+        bool same = true;
+        for (size_t l = 0, at = 0; l < layers.layers(); l++) {
+            std::vector<PackedPoint> expected;
+            for (size_t i = l * 4; i < count; i += 16) {
+                for (size_t j = i; j < i + 4 && j < count; j++) {
+                    for (size_t k = offsets[j]; k < offsets[j + 1]; k++) {
+                        PackedPoint q = listed[k];
+                        if (q.x >= 0 && q.y >= 0 && q.x <= WIDTH && q.y <= HEIGHT) expected.push_back(q);
+                    }
+                }
+            }
+            auto order = [](PackedPoint a, PackedPoint b) { return a.y != b.y ? a.y < b.y : a.x < b.x; };
+            std::sort(expected.begin(), expected.end(), order);
+            expected.erase(std::unique(expected.begin(), expected.end(), [](PackedPoint a, PackedPoint b) { return a.x == b.x && a.y == b.y; }), expected.end());
+            same = same && expected.size() == layers.unique(l);
+            for (size_t k = 0; k < expected.size() && same; k++, at++) {
+                same = expected[k].x == compacted[at].x && expected[k].y == compacted[at].y;
+            }
+        }
+
+        std::cout << "  " << count << " primitives\n"
+            << "    point lists " << total << " points, " << total * sizeof(PackedPoint) / 1e6 << " MB, " << listTime * 1e3 << " ms\n"
+            << "    masks       " << unique << " pixels, " << unique * sizeof(PackedPoint) / 1e6 << " MB + " << layers.bytes() / 1e6
+            << " MB of masks, " << maskTime * 1e3 << " ms" << (same ? "" : "  MISMATCH") << "\n";
+    }
+}
+
+static void BenchMorton() {
+    // big outlines on a 64 MB framebuffer, plotted as generated and Morton sorted
+    const int size = 4096;
+    struct Workload { const char* name; std::function<std::vector<Point>(float, float, float)> shape; };
+    const Workload workloads[] = {
+        { "circles", [](float x, float y, float r) { return MidpointCircle(x, y, r); } },
+        { "ellipses", [](float x, float y, float r) { return MidpointEllipse(x, y, r, r / 3); } },
+    };
+    std::vector<uint32_t> asGenerated((size_t)size * size), sorted((size_t)size * size);
+    std::vector<Point> scratch;
+
+    std::cout << "morton: " << size << "x" << size << " framebuffer\n";
+    for (const Workload& w : workloads) {
+        std::mt19937 random(19);
+        std::uniform_real_distribution<float> coordinate(0, (float)size), radius(200, 2000);
+        std::vector<Point> points;
+        for (int i = 0; i < 200; i++) {
+            std::vector<Point> shape = w.shape(coordinate(random), coordinate(random), radius(random));
+            points.insert(points.end(), shape.begin(), shape.end());
+        }
+
+        std::fill(asGenerated.begin(), asGenerated.end(), 0);
+        PlotSink plain{ asGenerated.data(), size, size, 0xFFFFFFFFu };
+        Clock::time_point start = Clock::now();
+        for (const Point& p : points) plain.put(p.x, p.y);
+        double plainTime = SecondsSince(start);
+
+        start = Clock::now();
+        MortonSort(points.data(), points.size(), scratch);
+        double sortTime = SecondsSince(start);
+
+        std::fill(sorted.begin(), sorted.end(), 0);
+        PlotSink ordered{ sorted.data(), size, size, 0xFFFFFFFFu };
+        start = Clock::now();
+        for (const Point& p : points) ordered.put(p.x, p.y);
+        double sortedTime = SecondsSince(start);
+
+        std::cout << "  200 " << w.name << ", " << points.size() << " points\n"
+            << "    as generated " << points.size() / plainTime / 1e6 << " M points/s\n"
+            << "    Morton order " << points.size() / sortedTime / 1e6 << " M points/s, sort " << sortTime * 1e3 << " ms"
+            << (asGenerated == sorted ? "" : "  MISMATCH") << "\n";
+    }
+}
+
+// full Bresenham, then each pixel tested against the pattern, the way to
+// get a dashed line without a patterned rasterizer
+struct PatternFilterSink {
+    BufferSink out;
+    uint32_t bits;
+    int64_t period, scale, step;
+
+    void put(float x, float y) {
+        if (bits >> (step++ % period / scale) & 1) out.put(x, y);
+    }
+};
+
+static void BenchDashed() {
+    struct Workload { const char* name; LinePattern pattern; };
+    const Workload workloads[] = {
+        { "dashed", DASHED_LINE },
+        { "dotted", DOTTED_LINE },
+        { "1 in 32, 8 px dots", { 0x1, 32, 8 } },
+    };
+    const float x1 = 0, y1 = 0, x2 = 1e7f, y2 = 3e6f;
+    std::vector<Point> filtered(BresenhamCount<LineMath::Integer>(x1, y1, x2, y2)), patterned(filtered.size());
+
+    std::cout << "dashed: Bresenham line of " << filtered.size() << " pixels\n";
+    for (const Workload& w : workloads) {
+        Clock::time_point start = Clock::now();
+        PatternFilterSink filter{ BufferSink(filtered.data()), w.pattern.bits, (int64_t)w.pattern.length * w.pattern.scale, w.pattern.scale, 0 };
+        Bresenham<LineMath::Integer>(x1, y1, x2, y2, filter);
+        size_t kept = filter.out.out - filtered.data();
+        double filterTime = SecondsSince(start);
+
+        start = Clock::now();
+        BufferSink sink(patterned.data());
+        PatternedBresenham(x1, y1, x2, y2, w.pattern, sink);
+        size_t drawn = sink.out - patterned.data();
+        double patternTime = SecondsSince(start);
+
+        bool same = kept == drawn && kept == PatternedBresenhamCount(x1, y1, x2, y2, w.pattern);
+        for (size_t i = 0; i < drawn && same; i++) {
+            same = filtered[i].x == patterned[i].x && filtered[i].y == patterned[i].y;
+        }
+        std::cout << "  " << w.name << ": " << drawn << " pixels drawn\n"
+            << "    filtered  " << filterTime * 1e3 << " ms\n"
+            << "    patterned " << patternTime * 1e3 << " ms, " << patternTime * 1e9 / std::max<size_t>(drawn, 1) << " ns a drawn pixel"
+            << (same ? "" : "  MISMATCH") << "\n";
+    }
+}
+
+static void BenchPolyline() {
+    // a GPS track sized path: 10^6 vertices a few pixels apart, wandering
+    std::mt19937 random(23);
+    std::normal_distribution<float> turn(0, 0.3f);
+    std::uniform_real_distribution<float> length(1, 12);
+    std::vector<Point> track(1000000);
+    float x = 0, y = 0, heading = 0;
+    for (Point& v : track) {
+        heading += turn(random);
+        float d = length(random);
+        x += d * std::cos(heading), y += d * std::sin(heading);
+        v = { x, y };
+    }
+
+    // one Bresenham() vector per segment, joints twice
+    Clock::time_point start = Clock::now();
+    std::vector<Point> perSegment;
+    for (size_t i = 0; i + 1 < track.size(); i++) {
+        std::vector<Point> segment = Bresenham<LineMath::Integer>(track[i].x, track[i].y, track[i + 1].x, track[i + 1].y);
+        perSegment.insert(perSegment.end(), segment.begin(), segment.end());
+    }
+    double segmentTime = SecondsSince(start);
+
+    start = Clock::now();
+    std::vector<Point> serial = Polyline(track);
+    double serialTime = SecondsSince(start);
+
+    JobSystem jobs(std::thread::hardware_concurrency());
+    start = Clock::now();
+    std::vector<Point> parallel = Polyline(track, jobs);
+    double parallelTime = SecondsSince(start);
+
+    bool same = serial.size() == parallel.size() && serial.size() + track.size() - 2 == perSegment.size();
+    for (size_t i = 0; i < serial.size() && same; i++) {
+        same = serial[i].x == parallel[i].x && serial[i].y == parallel[i].y;
+    }
+    std::cout << "polyline: " << track.size() << " vertices\n"
+        << "  per segment " << perSegment.size() << " points, " << segmentTime * 1e3 << " ms, " << perSegment.size() / segmentTime / 1e6 << " M points/s\n"
+        << "  polyline    " << serial.size() << " points, " << serialTime * 1e3 << " ms, " << serial.size() / serialTime / 1e6 << " M points/s\n"
+        << "  parallel    " << jobs.size() << " workers, " << parallelTime * 1e3 << " ms, " << parallel.size() / parallelTime / 1e6 << " M points/s"
+        << (same ? "" : "  MISMATCH") << "\n";
+}
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+static const Benchmark benchmarks[] = {
+    { "dda-batch", BenchDDABatch },
+    { "line-math", BenchLineMath },
+    { "filled", BenchFilled },
+    { "framebuffer", BenchFramebuffer },
+    { "wu-line", BenchWuLine },
+    { "job-batch", BenchJobBatch },
+    { "load", BenchLoad },
+    { "curves", BenchCurves },
+    { "voxels", BenchVoxels },
+    { "polygon", BenchPolygon },
+    { "fill", BenchRegionFill },
+    { "clip", BenchClip },
+    { "stream", BenchStream },
+    { "shape-cache", BenchShapeCache },
+    { "packed", BenchPacked },
+    { "occupancy", BenchOccupancy },
+    { "morton", BenchMorton },
+    { "dashed", BenchDashed },
+    { "polyline", BenchPolyline },
+};
+
+int main(int argc, char** argv) {
+    if (argc > 1 && argv[1] == std::string("sweep"))
+    {
+        return RunSweep(argc - 2, argv + 2);
+    }
+    for (const Benchmark& b : benchmarks) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; i++) {
+            selected = selected || b.name == std::string(argv[i]);
+        }
+        if (selected)
+        {
+            b.run();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "curves.h"
+
+using namespace std;
+
+
+// the curves have no closed form count, so these run the walk once without output
+
+size_t QuadraticBezierCount(float x0, float y0, float x1, float y1, float x2, float y2) {
+    CountingSink counter;
+    QuadraticBezier(x0, y0, x1, y1, x2, y2, counter);
+    return counter.count;
+}
+
+size_t CubicBezierCount(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3) {
+    CountingSink counter;
+    CubicBezier(x0, y0, x1, y1, x2, y2, x3, y3, counter);
+    return counter.count;
+}
+
+size_t CircularArcCount(float xc, float yc, float r, float startAngle, float sweepAngle) {
+    CountingSink counter;
+    CircularArc(xc, yc, r, startAngle, sweepAngle, counter);
+    return counter.count;
+}
+
+std::vector<Point> QuadraticBezier(float x0, float y0, float x1, float y1, float x2, float y2) {
+    std::vector<Point> points(QuadraticBezierCount(x0, y0, x1, y1, x2, y2));
+    BufferSink sink(points.data());
+    QuadraticBezier(x0, y0, x1, y1, x2, y2, sink);
+    return points;
+}
+
+std::vector<Point> CubicBezier(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3) {
+    std::vector<Point> points(CubicBezierCount(x0, y0, x1, y1, x2, y2, x3, y3));
+    BufferSink sink(points.data());
+    CubicBezier(x0, y0, x1, y1, x2, y2, x3, y3, sink);
+    return points;
+}
+
+std::vector<Point> CircularArc(float xc, float yc, float r, float startAngle, float sweepAngle) {
+    std::vector<Point> points(CircularArcCount(xc, yc, r, startAngle, sweepAngle));
+    BufferSink sink(points.data());
+    CircularArc(xc, yc, r, startAngle, sweepAngle, sink);
+    return points;
+}
@@ -0,0 +1,274 @@
+#ifndef CURVES_H
+#define CURVES_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+#include <utility>
+#include "primitives.h"
+
+// Curves rasterized directly to pixels, with the same sinks as the line and
+// circle generators. Consecutive pixels always touch (8-connected), no pixel
+// is emitted twice in a row and the corner pixel of an L shaped step is
+// dropped, so a curve looks like a Bresenham line that bends. A curve that
+// folds back close to itself can still cross its own pixels.
+
+
+// Keeps one pixel back so the corner of an L step can still be dropped.
+// With nothing pending the pending pixel is the last emitted one.
+template <typename Sink>
+class CurvePixels {
+public:
+    CurvePixels(Sink& sink, int64_t x, int64_t y) : sink(sink), px(x), py(y), qx(x), qy(y) {
+        sink.put((float)x, (float)y);
+    }
+
+    // the Bresenham line from the pending pixel to (x, y), in order. Only
+    // the first pixel or two can touch what came before the line, after
+    // that the pending pixel is simply passed on. The walk runs in major
+    // and minor coordinates, kept in locals since the sink's stores could
+    // otherwise alias the members.
+    void lineTo(int64_t x, int64_t y) {
+        // emitted and pending pixel and the end, along the major axis and across
+        bool steep = std::abs(y - qy) > std::abs(x - qx);
+        int64_t ea = px, eb = py, ka = qx, kb = qy, ta = x, tb = y;
+        if (steep)
+        {
+            std::swap(ea, eb), std::swap(ka, kb), std::swap(ta, tb);
+        }
+        int64_t major = std::abs(ta - ka), minor = std::abs(tb - kb);
+        int64_t majorStep = ta > ka ? 1 : -1, minorStep = tb > kb ? 1 : -1;
+        int64_t ca = ka, cb = kb, p = 2 * minor - major;
+        Sink& out = sink;
+        auto emit = [&] { steep ? out.put((float)kb, (float)ka) : out.put((float)ka, (float)kb); };
+        // the minor step is masked in, a branch on p would miss half the time
+        auto advance = [&] {
+            int64_t diagonal = ~(p >> 63);
+            ca += majorStep, cb += minorStep & diagonal;
+            p += 2 * minor - (2 * major & diagonal);
+        };
+        int64_t i = 0;
+        while (i < major) {
+            advance(), i++;
+            // both tests are rarely true, so each is one branch
+            if ((ca == ea) & (cb == eb))
+            {
+                // back where we were, the pending pixel was a detour
+                ka = ea, kb = eb;
+            }
+            else if (((uint64_t)(ca - ea + 1) <= 2) & ((uint64_t)(cb - eb + 1) <= 2))
+            {
+                // a pending pixel between two touching pixels is a corner and gets replaced
+                ka = ca, kb = cb;
+            }
+            else
+            {
+                if (ka != ea || kb != eb) emit();
+                ea = ka, eb = kb, ka = ca, kb = cb;
+                // the next pixel is two steps past the emitted one
+                break;
+            }
+            if (i == 2)
+            {
+                break;
+            }
+        }
+        if (i < major)
+        {
+            // the rest is passed straight on but for the last pixel, which
+            // stays pending. One loop per orientation keeps the registers free.
+            emit();
+            ea = ka, eb = kb;
+            int64_t first = i;
+            auto run = [&](auto plot) {
+                for (; i < major - 1; i++) {
+                    advance();
+                    plot();
+                }
+            };
+            if (steep)
+            {
+                run([&] { out.put((float)cb, (float)ca); });
+            }
+            else
+            {
+                run([&] { out.put((float)ca, (float)cb); });
+            }
+            if (i > first)
+            {
+                ea = ca, eb = cb;
+            }
+            advance();
+            ka = ca, kb = cb;
+        }
+        if (steep)
+        {
+            std::swap(ea, eb), std::swap(ka, kb);
+        }
+        px = ea, py = eb, qx = ka, qy = kb;
+    }
+
+    void finish() {
+        if (qx != px || qy != py) sink.put((float)qx, (float)qy);
+        px = qx, py = qy;
+    }
+
+private:
+    Sink& sink;
+    int64_t px, py;   // last emitted
+    int64_t qx, qy;   // pending
+};
+
+
+// nearest pixel, halves rounding up. The offset makes the value positive so
+// the conversion truncates like floor, which is much cheaper than llround.
+inline int64_t CurvePixel(double v) {
+    const double OFFSET = 2147483648.0;
+    return (int64_t)(v + (OFFSET + 0.5)) - (int64_t)OFFSET;
+}
+
+// Adaptive forward differencing of p(t) = a t^3 + b t^2 + c t + d over
+// t = 0..1. The three forward differences step the curve with additions
+// only, and each step is drawn as a Bresenham chord between the rounded
+// ends, so a flat stretch costs integer steps per pixel instead of a
+// curve step. A chord strays from the curve by about an eighth of the
+// second difference, so a step whose second difference is over FLAT on
+// either axis is halved before it is taken, which keeps every chord within
+// a pixel of the curve. The step is doubled only after a few steps in a
+// row where the doubled one would still fit, so h stays put instead of
+// bouncing. t is kept as a fraction of 2^40 so
+// halving and doubling stay exact, and the last step lands on the exact
+// end point. Coordinates must stay within +-2^31.
+template <typename Sink>
+void ForwardDifferenceCurve(const double a[2], const double b[2], const double c[2], const double d[2], Sink& sink) {
+    const uint64_t ONE = uint64_t(1) << 40;
+    const double FLAT = 8;  // largest second difference a chord may cover
+    const int SETTLE = 4;   // steps in a row that fit doubled before the step doubles
+    double px = d[0], py = d[1];
+    // differences for the step h = 1
+    double d1x = a[0] + b[0] + c[0], d2x = 6 * a[0] + 2 * b[0], d3x = 6 * a[0];
+    double d1y = a[1] + b[1] + c[1], d2y = 6 * a[1] + 2 * b[1], d3y = 6 * a[1];
+
+    CurvePixels<Sink> pixels(sink, CurvePixel(px), CurvePixel(py));
+    // t is always a multiple of h, so no step overshoots the end
+    uint64_t t = 0, h = ONE;
+    int fitSteps = 0;
+    while (t < ONE) {
+        while (h > 1 && std::max(std::abs(d2x), std::abs(d2y)) > FLAT) {
+            h >>= 1, fitSteps = 0;
+            d3x /= 8, d2x = d2x / 4 - d3x, d1x = (d1x - d2x) / 2;
+            d3y /= 8, d2y = d2y / 4 - d3y, d1y = (d1y - d2y) / 2;
+        }
+        if (h == ONE - t)
+        {
+            // the exact end can be a rounding away from where the sums put it
+            pixels.lineTo(CurvePixel(a[0] + b[0] + c[0] + d[0]), CurvePixel(a[1] + b[1] + c[1] + d[1]));
+            break;
+        }
+
+        t += h;
+        px += d1x, d1x += d2x, d2x += d3x;
+        py += d1y, d1y += d2y, d2y += d3y;
+        pixels.lineTo(CurvePixel(px), CurvePixel(py));
+
+        // the doubled step's second difference is 4 (d2 + d3)
+        fitSteps = 4 * std::max(std::abs(d2x + d3x), std::abs(d2y + d3y)) <= FLAT ? fitSteps + 1 : 0;
+        // only double where the bigger step starts on its own grid
+        if (fitSteps >= SETTLE && h < ONE && (t & (2 * h - 1)) == 0)
+        {
+            h <<= 1, fitSteps = 0;
+            d1x = 2 * d1x + d2x, d2x = 4 * d2x + 4 * d3x, d3x *= 8;
+            d1y = 2 * d1y + d2y, d2y = 4 * d2y + 4 * d3y, d3y *= 8;
+        }
+    }
+    pixels.finish();
+}
+
+// from (x0, y0) to (x2, y2), pulled towards (x1, y1)
+template <typename Sink>
+void QuadraticBezier(float x0, float y0, float x1, float y1, float x2, float y2, Sink& sink) {
+    const double a[2] = { 0, 0 };
+    const double b[2] = { (double)x0 - 2.0 * x1 + x2, (double)y0 - 2.0 * y1 + y2 };
+    const double c[2] = { 2.0 * ((double)x1 - x0), 2.0 * ((double)y1 - y0) };
+    const double d[2] = { x0, y0 };
+    ForwardDifferenceCurve(a, b, c, d, sink);
+}
+
+// from (x0, y0) to (x3, y3) with control points (x1, y1) and (x2, y2)
+template <typename Sink>
+void CubicBezier(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3, Sink& sink) {
+    const double a[2] = { -(double)x0 + 3.0 * x1 - 3.0 * x2 + x3, -(double)y0 + 3.0 * y1 - 3.0 * y2 + y3 };
+    const double b[2] = { 3.0 * x0 - 6.0 * x1 + 3.0 * x2, 3.0 * y0 - 6.0 * y1 + 3.0 * y2 };
+    const double c[2] = { 3.0 * ((double)x1 - x0), 3.0 * ((double)y1 - y0) };
+    const double d[2] = { x0, y0 };
+    ForwardDifferenceCurve(a, b, c, d, sink);
+}
+
+
+// Increases with the angle of (x, y) like atan2 does, over [0, 4) instead
+// of [0, 2 pi), and needs only a division.
+inline double PseudoAngle(double x, double y) {
+    if (y >= 0) return x >= 0 ? y / (x + y) : 1 + -x / (-x + y);
+    return x < 0 ? 2 + -y / (-x - y) : 3 + x / (x - y);
+}
+
+// Part of MidpointCircleUnique() from startAngle, counter-clockwise over
+// sweepAngle (radians), walked in order from the start. The arc keeps the
+// circle's pixels exactly, so arcs that split a circle between them draw it
+// without gaps. A negative sweep draws the same pixels walked from the
+// other end. Only the octants the arc touches are walked.
+template <typename Sink>
+void CircularArc(float xc, float yc, float fr, float startAngle, float sweepAngle, Sink& sink) {
+    int64_t r = (int64_t)std::llround(fr);
+    if (r <= 0)
+    {
+        if (r == 0) sink.put(xc, yc);
+        return;
+    }
+    if (sweepAngle < 0)
+    {
+        startAngle += sweepAngle, sweepAngle = -sweepAngle;
+    }
+
+    const double QUARTER = 1.5707963267948966;
+    bool full = sweepAngle >= 4 * QUARTER;
+    double start = PseudoAngle(std::cos((double)startAngle), std::sin((double)startAngle));
+    double end = PseudoAngle(std::cos((double)startAngle + sweepAngle), std::sin((double)startAngle + sweepAngle));
+    // pseudo angle gone past the start, 0..4
+    auto along = [&](double angle) { return angle >= start ? angle - start : angle + 4 - start; };
+    double length = full ? 4 : along(end);
+
+    int first = std::min((int)(start * 2), 7);
+    for (int k = 0; k <= 8; k++) {
+        int octant = (first + k) % 8;
+        if (k > 0 && along(octant * 0.5) > length)
+        {
+            break;
+        }
+        MidpointCircleOctant(r, octant, [&](int64_t dx, int64_t dy) {
+            double angle = PseudoAngle((double)dx, (double)dy);
+            // the first octant is visited twice, once from the start on and
+            // once more at the end for what lies before the start
+            bool before = angle < start;
+            if ((k == 0 && before) || (k == 8 && !before) || along(angle) > length)
+            {
+                return;
+            }
+            sink.put(xc + (float)dx, yc + (float)dy);
+        });
+    }
+}
+
+
+size_t QuadraticBezierCount(float x0, float y0, float x1, float y1, float x2, float y2);
+size_t CubicBezierCount(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3);
+size_t CircularArcCount(float xc, float yc, float r, float startAngle, float sweepAngle);
+
+std::vector<Point> QuadraticBezier(float x0, float y0, float x1, float y1, float x2, float y2);
+std::vector<Point> CubicBezier(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3);
+std::vector<Point> CircularArc(float xc, float yc, float r, float startAngle, float sweepAngle);
+
+#endif
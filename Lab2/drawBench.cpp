@@ -0,0 +1,403 @@
+#include <glad/glad.h>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include "primitives.h"
+#include "geometryStore.h"
+#include "shapeInstances.h"
+#include "layerStore.h"
+#include "headlessGL.h"
+
+using namespace std;
+
+// CPU cost of a frame of the Lab2 scene drawn the old way, one temporary
+// VAO and VBO per primitive per frame, against the retained GeometryStore,
+// which draws the same points with one glMultiDrawArrays per run of
+// primitives sharing a color. GL calls are counted by wrapping the glad
+// function pointers. Both are measured again
+// with int16 positions (PackedPoint) for the bytes each moves, and the
+// scene once more through a LayerStore, which uploads every pixel once,
+// and with each primitive's points in Morton order. With a radii count the
+// extra circles and ellipses only use that many sizes, and the circles and
+// ellipses are also drawn as instances of cached shapes (shapeInstances.h).
+//   g++ -O2 -std=c++17 -I../LIBRARIES/include drawBench.cpp headlessGL.cpp geometryStore.cpp mortonOrder.cpp layerStore.cpp occupancy.cpp regionFill.cpp shapeInstances.cpp shapeCache.cpp primitiveBatch.cpp viewportClip.cpp jobSystem.cpp primitives.cpp "../Index element/glad.c" -lEGL -ldl -pthread -o drawBench
+//   EGL_PLATFORM=surfaceless ./drawBench [extra random primitives] [frames] [radii]
+
+
+typedef std::chrono::steady_clock Clock;
+
+static size_t glCalls = 0;
+
+// replaces a glad function pointer with one that counts the call first
+template <int Id, typename R, typename... Args>
+struct CountedCall {
+    static R (APIENTRYP real)(Args...);
+    static R APIENTRY call(Args... args) { glCalls++; return real(args...); }
+};
+template <int Id, typename R, typename... Args>
+R (APIENTRYP CountedCall<Id, R, Args...>::real)(Args...) = nullptr;
+
+template <int Id, typename R, typename... Args>
+void CountCalls(R (APIENTRYP& slot)(Args...)) {
+    CountedCall<Id, R, Args...>::real = slot;
+    slot = &CountedCall<Id, R, Args...>::call;
+}
+#define COUNT_CALLS(name) CountCalls<__LINE__>(glad_##name)
+
+static void CountDrawCalls() {
+    COUNT_CALLS(glGenVertexArrays);
+    COUNT_CALLS(glGenBuffers);
+    COUNT_CALLS(glBindVertexArray);
+    COUNT_CALLS(glBindBuffer);
+    COUNT_CALLS(glBufferData);
+    COUNT_CALLS(glVertexAttribPointer);
+    COUNT_CALLS(glEnableVertexAttribArray);
+    COUNT_CALLS(glUseProgram);
+    COUNT_CALLS(glGetUniformLocation);
+    COUNT_CALLS(glUniform3f);
+    COUNT_CALLS(glPointSize);
+    COUNT_CALLS(glDrawArrays);
+    COUNT_CALLS(glMultiDrawArrays);
+    COUNT_CALLS(glDrawArraysInstanced);
+    COUNT_CALLS(glDeleteVertexArrays);
+    COUNT_CALLS(glDeleteBuffers);
+    COUNT_CALLS(glClearColor);
+    COUNT_CALLS(glClear);
+}
+
+
+const char* vertexShaderSource = R"glsl(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    void main() {
+        gl_Position = vec4((aPos - 500.0) / 500.0, 0.0, 1.0);
+    }
+)glsl";
+
+const char* fragmentShaderSource = R"glsl(
+    #version 330 core
+    out vec4 FragColor;
+    uniform vec3 color;
+    void main() {
+        FragColor = vec4(color, 1.0);
+    }
+)glsl";
+
+const char* storeVertexShaderSource = R"glsl(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in vec4 aColor;
+    out vec4 pointColor;
+    void main() {
+        gl_Position = vec4((aPos - 500.0) / 500.0, 0.0, 1.0);
+        pointColor = aColor;
+    }
+)glsl";
+
+const char* storeFragmentShaderSource = R"glsl(
+    #version 330 core
+    in vec4 pointColor;
+    out vec4 FragColor;
+    void main() {
+        FragColor = pointColor;
+    }
+)glsl";
+
+// cached shapes: the point comes relative to the centre of its instance
+const char* instanceVertexShaderSource = R"glsl(
+    #version 330 core
+    layout (location = 0) in vec2 aOffset;
+    layout (location = 1) in vec2 aCenter;
+    layout (location = 2) in vec4 aColor;
+    out vec4 pointColor;
+    void main() {
+        gl_Position = vec4((aCenter + aOffset - 500.0) / 500.0, 0.0, 1.0);
+        pointColor = aColor;
+    }
+)glsl";
+
+static GLuint CreateProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vertexSource, NULL);
+    glCompileShader(vertexShader);
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
+    glCompileShader(fragmentShader);
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return program;
+}
+
+// position attribute type of each vertex format
+static GLenum PositionType(const Point*) { return GL_FLOAT; }
+static GLenum PositionType(const PackedPoint*) { return GL_SHORT; }
+
+// the per frame upload main.cpp used to do for every primitive
+template <typename Vertex>
+static void drawPoints(const std::vector<Vertex>& points, GLuint shader, float r, float g, float b) {
+    unsigned int VAO, VBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(Vertex), points.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, PositionType(points.data()), GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glUseProgram(shader);
+    glUniform3f(glGetUniformLocation(shader, "color"), r, g, b);
+    glPointSize(2.0f);
+    glDrawArrays(GL_POINTS, 0, points.size());
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+}
+
+struct Colored { Primitive primitive; float r, g, b; };
+
+struct FrameCost { double cpuMicros, gpuMicros; size_t calls; };
+
+// issue time and GL calls of one frame averaged over frames, plus the time
+// until the driver has finished it
+template <typename Draw>
+static FrameCost Measure(int frames, Draw draw) {
+    FrameCost cost = {};
+    for (int f = 0; f < frames; f++) {
+        size_t callsBefore = glCalls;
+        Clock::time_point start = Clock::now();
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        draw();
+        Clock::time_point issued = Clock::now();
+        glFinish();
+        cost.cpuMicros += std::chrono::duration<double, std::micro>(issued - start).count();
+        cost.gpuMicros += std::chrono::duration<double, std::micro>(Clock::now() - issued).count();
+        cost.calls += glCalls - callsBefore;
+    }
+    cost.cpuMicros /= frames, cost.gpuMicros /= frames, cost.calls /= frames;
+    return cost;
+}
+
+int main(int argc, char** argv) {
+    size_t extra = argc > 1 ? std::stoul(argv[1]) : 0;
+    int frames = argc > 2 ? std::stoi(argv[2]) : 200;
+    int radii = argc > 3 ? std::stoi(argv[3]) : 0;
+    if (!CreateHeadlessContext())
+    {
+        std::cout << "Failed to create a headless GL context" << std::endl;
+        return 1;
+    }
+    CreateRenderTarget(WIDTH, HEIGHT);
+    CountDrawCalls();
+    std::cout << glGetString(GL_RENDERER) << std::endl;
+
+    // the default Lab2 scene, optionally with more primitives on top
+    std::vector<Colored> scene = {
+        { { PrimitiveType::BresenhamLine, 0, HEIGHT / 2, WIDTH, HEIGHT / 2 }, 1, 1, 1 },
+        { { PrimitiveType::BresenhamLine, WIDTH / 2, 0, WIDTH / 2, HEIGHT }, 1, 1, 1 },
+        { { PrimitiveType::DDALine, 100, 200, 900, 800 }, 1, 0, 0 },
+        { { PrimitiveType::BresenhamLine, 200, 900, 800, 100 }, 0, 1, 0 },
+        { { PrimitiveType::Circle, 500, 500, 300, 0 }, 0, 0, 1 },
+        { { PrimitiveType::Ellipse, 500, 500, 400, 200 }, 1, 1, 0 },
+    };
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> coordinate(0, 1000), size(1, 100);
+    std::uniform_int_distribution<int> pick(0, std::max(radii, 1) - 1);
+    for (size_t i = 0; i < extra; i++) {
+        PrimitiveType type = (PrimitiveType)(i % 4);
+        bool line = type == PrimitiveType::DDALine || type == PrimitiveType::BresenhamLine;
+        float x = coordinate(random), y = coordinate(random), a = size(random), b = size(random);
+        if (!line && radii > 0)
+        {
+            // sizes from a short list, ellipses pair every radius with the next
+            int k = pick(random);
+            a = 1 + 99.0f * k / radii, b = 1 + 99.0f * ((k + 1) % radii) / radii;
+        }
+        scene.push_back({ { type, x, y, line ? coordinate(random) : a, b }, 1, 0.5f, 0 });
+    }
+
+    // before: the points stay on the CPU and go up again every frame
+    std::vector<std::vector<Point>> points;
+    size_t total = 0;
+    for (const Colored& c : scene) {
+        points.emplace_back(PrimitiveCount(c.primitive));
+        GeneratePrimitive(c.primitive, points.back().data());
+        total += points.back().size();
+    }
+    GLuint shader = CreateProgram(vertexShaderSource, fragmentShaderSource);
+    FrameCost before = Measure(frames, [&] {
+        for (size_t i = 0; i < scene.size(); i++) {
+            drawPoints(points[i], shader, scene[i].r, scene[i].g, scene[i].b);
+        }
+    });
+    std::vector<uint32_t> beforeImage(WIDTH * HEIGHT), afterImage(WIDTH * HEIGHT);
+    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, beforeImage.data());
+
+    // after: generated once into the store
+    JobSystem jobs;
+    GeometryStore store;
+    for (const Colored& c : scene) {
+        store.add(c.primitive, c.r, c.g, c.b);
+    }
+    store.upload(jobs);
+    GLuint storeShader = CreateProgram(storeVertexShaderSource, storeFragmentShaderSource);
+    FrameCost after = Measure(frames, [&] { store.draw(storeShader, 2.0f); });
+    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, afterImage.data());
+
+    std::cout << scene.size() << " primitives, " << total << " points, " << frames << " frames" << std::endl;
+    std::cout << "per frame upload: " << before.cpuMicros << " us issuing, " << before.gpuMicros << " us finishing, " << before.calls << " GL calls" << std::endl;
+    std::cout << "retained store:   " << after.cpuMicros << " us issuing, " << after.gpuMicros << " us finishing, " << after.calls << " GL calls" << std::endl;
+    std::cout << (beforeImage == afterImage ? "same image" : "IMAGES DIFFER") << std::endl;
+
+    // the same two ways with int16 positions
+    std::vector<std::vector<PackedPoint>> packedPoints;
+    for (const std::vector<Point>& p : points) {
+        packedPoints.emplace_back(p.size());
+        std::transform(p.begin(), p.end(), packedPoints.back().begin(), [](Point q) {
+            return PackedPoint{ PackCoordinate(q.x), PackCoordinate(q.y) };
+        });
+    }
+    FrameCost packedBefore = Measure(frames, [&] {
+        for (size_t i = 0; i < scene.size(); i++) {
+            drawPoints(packedPoints[i], shader, scene[i].r, scene[i].g, scene[i].b);
+        }
+    });
+    std::vector<uint32_t> packedBeforeImage(WIDTH * HEIGHT), packedAfterImage(WIDTH * HEIGHT);
+    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, packedBeforeImage.data());
+
+    GeometryStore packedStore;
+    for (const Colored& c : scene) {
+        packedStore.add(c.primitive, c.r, c.g, c.b);
+    }
+    packedStore.packPoints(true);
+    packedStore.upload(jobs);
+    Measure(1, [&] { packedStore.draw(storeShader, 2.0f); });
+    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, packedAfterImage.data());
+
+    size_t moved = 0;
+    for (size_t i = 0; i < WIDTH * HEIGHT; i++) moved += packedBeforeImage[i] != beforeImage[i];
+    std::cout << "per frame upload: " << total * sizeof(Point) / 1024 << " KB a frame as floats, " << total * sizeof(PackedPoint) / 1024
+        << " KB packed, " << packedBefore.cpuMicros << " us issuing, " << packedBefore.gpuMicros << " us finishing" << std::endl;
+    std::cout << "retained store:   " << store.bytes() / 1024 << " KB as floats, " << packedStore.bytes() / 1024 << " KB packed" << std::endl;
+    std::cout << moved << " pixels moved by rounding, " << (packedBeforeImage == packedAfterImage ? "same image" : "IMAGES DIFFER") << " packed" << std::endl;
+    packedStore.release();
+
+    // each primitive's points in Morton order, drawn every frame for the cost of one sort
+    GeometryStore mortonStore;
+    for (const Colored& c : scene) {
+        mortonStore.add(c.primitive, c.r, c.g, c.b);
+    }
+    mortonStore.mortonOrder(true);
+    Clock::time_point sortStart = Clock::now();
+    mortonStore.upload(jobs);
+    double sortedUpload = std::chrono::duration<double, std::milli>(Clock::now() - sortStart).count();
+    FrameCost morton = Measure(frames, [&] { mortonStore.draw(storeShader, 2.0f); });
+    std::vector<uint32_t> mortonImage(WIDTH * HEIGHT);
+    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, mortonImage.data());
+    std::cout << "Morton store:     " << morton.cpuMicros << " us issuing, " << morton.gpuMicros << " us finishing, "
+        << sortedUpload << " ms to generate and sort, " << (mortonImage == afterImage ? "same image" : "IMAGES DIFFER") << std::endl;
+    mortonStore.release();
+
+    // every pixel once per color, against a packed store drawing the colors in the same order
+    LayerStore layers;
+    for (const Colored& c : scene) {
+        layers.add(c.primitive, c.r, c.g, c.b);
+    }
+    layers.upload(jobs);
+    FrameCost layered = Measure(frames, [&] { layers.draw(storeShader, 2.0f); });
+    std::vector<uint32_t> layeredImage(WIDTH * HEIGHT), byColorImage(WIDTH * HEIGHT);
+    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, layeredImage.data());
+
+    GeometryStore byColor;
+    std::vector<uint32_t> colorOrder;
+    for (const Colored& c : scene) {
+        uint32_t color = PackColor(c.r, c.g, c.b);
+        if (std::find(colorOrder.begin(), colorOrder.end(), color) == colorOrder.end()) colorOrder.push_back(color);
+    }
+    for (uint32_t color : colorOrder) {
+        for (const Colored& c : scene) {
+            if (PackColor(c.r, c.g, c.b) == color) byColor.add(c.primitive, c.r, c.g, c.b);
+        }
+    }
+    byColor.packPoints(true);
+    byColor.upload(jobs);
+    Measure(1, [&] { byColor.draw(storeShader, 2.0f); });
+    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, byColorImage.data());
+
+    size_t emitted = 0;
+    for (size_t i = 0; i < layers.layers().layers(); i++) emitted += layers.layers().emitted(i);
+    std::cout << "layer store:      " << layered.cpuMicros << " us issuing, " << layered.gpuMicros << " us finishing, " << layered.calls << " GL calls, "
+        << layers.layers().layers() << " colors, " << emitted << " points to " << layers.points() << " pixels, "
+        << layers.bytes() / 1024 << " KB uploaded against " << byColor.bytes() / 1024 << " KB, "
+        << layers.layers().bytes() / 1024 << " KB of masks" << std::endl;
+    std::cout << (layeredImage == byColorImage ? "same image" : "IMAGES DIFFER") << std::endl;
+    layers.release();
+    byColor.release();
+
+    if (radii > 0)
+    {
+        // lines from a store, circles and ellipses as instances of cached shapes
+        ShapeCache cache;
+        ShapeInstances instances(cache);
+        GeometryStore lines;
+        for (const Colored& c : scene) {
+            bool shape = c.primitive.type == PrimitiveType::Circle || c.primitive.type == PrimitiveType::Ellipse;
+            shape ? instances.add(c.primitive, c.r, c.g, c.b) : lines.add(c.primitive, c.r, c.g, c.b);
+        }
+        lines.upload(jobs);
+        instances.upload();
+        GLuint instanceShader = CreateProgram(instanceVertexShaderSource, storeFragmentShaderSource);
+        FrameCost instanced = Measure(frames, [&] {
+            lines.draw(storeShader, 2.0f);
+            instances.draw(instanceShader, 2.0f);
+        });
+        std::vector<uint32_t> instancedImage(WIDTH * HEIGHT), groupedImage(WIDTH * HEIGHT);
+        glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, instancedImage.data());
+
+        // instances draw shape by shape, so compare with a store drawing in that order
+        GeometryStore grouped;
+        std::vector<const Colored*> shapes;
+        for (const Colored& c : scene) {
+            bool shape = c.primitive.type == PrimitiveType::Circle || c.primitive.type == PrimitiveType::Ellipse;
+            shape ? shapes.push_back(&c) : grouped.add(c.primitive, c.r, c.g, c.b);
+        }
+        std::vector<size_t> order;
+        std::vector<ShapePoints> seen;
+        for (const Colored* c : shapes) {
+            const Primitive& p = c->primitive;
+            ShapePoints points = p.type == PrimitiveType::Circle ? cache.circle(p.x2) : cache.ellipse(p.x2, p.y2);
+            order.push_back(std::find(seen.begin(), seen.end(), points) - seen.begin());
+            if (order.back() == seen.size()) seen.push_back(points);
+        }
+        for (size_t k = 0; k < seen.size(); k++) {
+            for (size_t i = 0; i < shapes.size(); i++) {
+                if (order[i] == k) grouped.add(shapes[i]->primitive, shapes[i]->r, shapes[i]->g, shapes[i]->b);
+            }
+        }
+        grouped.upload(jobs);
+        Measure(1, [&] { grouped.draw(storeShader, 2.0f); });
+        glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, groupedImage.data());
+
+        ShapeCache::Stats stats = cache.stats();
+        std::cout << "instanced shapes: " << instanced.cpuMicros << " us issuing, " << instanced.gpuMicros << " us finishing, "
+            << instanced.calls << " GL calls, " << instances.instances() << " circles and ellipses as " << instances.shapes()
+            << " shapes, " << instances.points() << " shape points uploaded" << std::endl;
+        std::cout << "shape cache: " << stats.hitRate() * 100 << "% hits, " << stats.entries << " shapes, " << stats.bytes / 1024 << " KB" << std::endl;
+        std::cout << (instancedImage == groupedImage ? "same image" : "IMAGES DIFFER") << std::endl;
+
+        lines.release();
+        grouped.release();
+        instances.release();
+        glDeleteProgram(instanceShader);
+    }
+
+    store.release();
+    glDeleteProgram(shader);
+    glDeleteProgram(storeShader);
+    return 0;
+}
@@ -0,0 +1,325 @@
+#include "framebuffer.h"
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+
+using namespace std;
+
+
+// FRAMEBUFFER
+
+// a bin entry for a span is its rectangle inside one tile, 6 bits per edge
+static uint32_t PackRect(int x1, int y1, int x2, int y2) {
+    return (uint32_t)(x1 | x2 << 6 | y1 << 12 | y2 << 18);
+}
+
+Framebuffer::Framebuffer(int width, int height, unsigned threads)
+    : w(width), h(height),
+    tilesX((width + TILE - 1) / TILE), tilesY((height + TILE - 1) / TILE),
+    pixels((size_t)tilesX * tilesY * TILE * TILE, 0xFF000000u),
+    jobs(std::max(threads, 1u)) {
+}
+
+void Framebuffer::clear(float r, float g, float b) {
+    uint32_t color = PackColor(r, g, b);
+    jobs.parallelFor((size_t)tilesX * tilesY, 1, [&](size_t first, size_t last) {
+        for (size_t tile = first; tile < last; tile++) {
+            std::fill_n(&pixels[tile * TILE * TILE], TILE * TILE, color);
+        }
+    });
+}
+
+void Framebuffer::resetBins(size_t chunks) {
+    // clear() keeps the capacity, so after the first few draws binning no longer allocates
+    bins.resize(std::max(bins.size(), chunks * tilesX * tilesY));
+    for (std::vector<uint32_t>& bin : bins) {
+        bin.clear();
+    }
+}
+
+void Framebuffer::drawPoints(const Point* points, size_t count, float r, float g, float b) {
+    uint32_t color = PackColor(r, g, b);
+    size_t chunks = jobs.size(), tiles = (size_t)tilesX * tilesY;
+    resetBins(chunks);
+
+    jobs.parallelFor(chunks, 1, [&](size_t first, size_t last) {
+        for (size_t chunk = first; chunk < last; chunk++) {
+            std::vector<uint32_t>* own = &bins[chunk * tiles];
+            for (size_t i = count * chunk / chunks, end = count * (chunk + 1) / chunks; i < end; i++) {
+                float fx = std::floor(points[i].x), fy = std::floor(points[i].y);
+                if (!(fx >= 0 && fy >= 0 && fx < w && fy < h))
+                {
+                    continue;
+                }
+                int x = (int)fx, y = (int)fy;
+                own[(y / TILE) * tilesX + x / TILE].push_back((uint32_t)((y % TILE) * TILE + x % TILE));
+            }
+        }
+    });
+
+    std::vector<size_t> plotted(tiles);
+    jobs.parallelFor(tiles, 1, [&](size_t first, size_t last) {
+        for (size_t tile = first; tile < last; tile++) {
+            uint32_t* block = &pixels[tile * TILE * TILE];
+            for (size_t chunk = 0; chunk < chunks; chunk++) {
+                for (uint32_t offset : bins[chunk * tiles + tile]) {
+                    block[offset] = color;
+                }
+                plotted[tile] += bins[chunk * tiles + tile].size();
+            }
+        }
+    });
+    for (size_t n : plotted) drawn += n;
+}
+
+void Framebuffer::drawSpans(const Span* spans, size_t count, float r, float g, float b) {
+    uint32_t color = PackColor(r, g, b);
+    size_t chunks = jobs.size(), tiles = (size_t)tilesX * tilesY;
+    resetBins(chunks);
+
+    // a span is cut at the tile borders and every piece goes to its own tile
+    jobs.parallelFor(chunks, 1, [&](size_t first, size_t last) {
+        for (size_t chunk = first; chunk < last; chunk++) {
+            std::vector<uint32_t>* own = &bins[chunk * tiles];
+            for (size_t i = count * chunk / chunks, end = count * (chunk + 1) / chunks; i < end; i++) {
+                const Span& s = spans[i];
+                float fx1 = std::floor(std::min(s.x1, s.x2)), fx2 = std::floor(std::max(s.x1, s.x2));
+                float fy1 = std::floor(std::min(s.y1, s.y2)), fy2 = std::floor(std::max(s.y1, s.y2));
+                if (!(fx2 >= 0 && fy2 >= 0 && fx1 < w && fy1 < h))
+                {
+                    continue;
+                }
+                int x1 = (int)std::max(fx1, 0.0f), x2 = (int)std::min(fx2, (float)(w - 1));
+                int y1 = (int)std::max(fy1, 0.0f), y2 = (int)std::min(fy2, (float)(h - 1));
+
+                for (int ty = y1 / TILE; ty <= y2 / TILE; ty++) {
+                    for (int tx = x1 / TILE; tx <= x2 / TILE; tx++) {
+                        int left = std::max(x1, tx * TILE) - tx * TILE, right = std::min(x2, tx * TILE + TILE - 1) - tx * TILE;
+                        int bottom = std::max(y1, ty * TILE) - ty * TILE, top = std::min(y2, ty * TILE + TILE - 1) - ty * TILE;
+                        own[ty * tilesX + tx].push_back(PackRect(left, bottom, right, top));
+                    }
+                }
+            }
+        }
+    });
+
+    std::vector<size_t> plotted(tiles);
+    jobs.parallelFor(tiles, 1, [&](size_t first, size_t last) {
+        for (size_t tile = first; tile < last; tile++) {
+            uint32_t* block = &pixels[tile * TILE * TILE];
+            for (size_t chunk = 0; chunk < chunks; chunk++) {
+                for (uint32_t rect : bins[chunk * tiles + tile]) {
+                    int x1 = rect & 63, x2 = rect >> 6 & 63, y1 = rect >> 12 & 63, y2 = rect >> 18 & 63;
+                    for (int y = y1; y <= y2; y++) {
+                        FillPixels(block + y * TILE + x1, x2 - x1 + 1, color);
+                    }
+                    plotted[tile] += (size_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+                }
+            }
+        }
+    });
+    for (size_t n : plotted) drawn += n;
+}
+
+void Framebuffer::drawCoverage(const CoveragePoint* points, size_t count, float r, float g, float b) {
+    uint32_t color = PackColor(r, g, b);
+    size_t chunks = jobs.size(), tiles = (size_t)tilesX * tilesY;
+    resetBins(chunks);
+
+    // the entry keeps the pixel offset in the low 12 bits and the coverage above it
+    jobs.parallelFor(chunks, 1, [&](size_t first, size_t last) {
+        for (size_t chunk = first; chunk < last; chunk++) {
+            std::vector<uint32_t>* own = &bins[chunk * tiles];
+            for (size_t i = count * chunk / chunks, end = count * (chunk + 1) / chunks; i < end; i++) {
+                float fx = std::floor(points[i].x), fy = std::floor(points[i].y);
+                uint32_t alpha = (uint32_t)std::lround(std::min(std::max(points[i].coverage, 0.0f), 1.0f) * 255);
+                if (!(fx >= 0 && fy >= 0 && fx < w && fy < h) || alpha == 0)
+                {
+                    continue;
+                }
+                int x = (int)fx, y = (int)fy;
+                own[(y / TILE) * tilesX + x / TILE].push_back((uint32_t)((y % TILE) * TILE + x % TILE) | alpha << 12);
+            }
+        }
+    });
+
+    std::vector<size_t> plotted(tiles);
+    jobs.parallelFor(tiles, 1, [&](size_t first, size_t last) {
+        for (size_t tile = first; tile < last; tile++) {
+            uint32_t* block = &pixels[tile * TILE * TILE];
+            for (size_t chunk = 0; chunk < chunks; chunk++) {
+                for (uint32_t entry : bins[chunk * tiles + tile]) {
+                    uint32_t& dst = block[entry & 0xFFF];
+                    uint32_t a = entry >> 12, blended = 0xFF000000u;
+                    for (int shift = 0; shift < 24; shift += 8) {
+                        uint32_t src = color >> shift & 0xFF, old = dst >> shift & 0xFF;
+                        blended |= (src * a + old * (255 - a) + 127) / 255 << shift;
+                    }
+                    dst = blended;
+                }
+                plotted[tile] += bins[chunk * tiles + tile].size();
+            }
+        }
+    });
+    for (size_t n : plotted) drawn += n;
+}
+
+void Framebuffer::fillPolygon(const Point* vertices, size_t count, FillRule rule, float r, float g, float b) {
+    uint32_t color = PackColor(r, g, b);
+    EdgeTable table(vertices, count);
+
+    // every row of tiles scans its own 64 rows straight into its tiles, no binning
+    struct TileRowSink {
+        Framebuffer& target;
+        uint32_t color;
+        size_t plotted;
+
+        void put(const Span& s) {
+            int y = (int)s.y1, x1 = std::max((int)s.x1, 0), x2 = std::min((int)s.x2, target.w - 1);
+            for (int tx = x1 / TILE; x1 <= x2; tx++) {
+                int right = std::min(x2, tx * TILE + TILE - 1);
+                size_t tile = (size_t)(y / TILE) * target.tilesX + tx;
+                FillPixels(&target.pixels[tile * TILE * TILE + (y % TILE) * TILE + x1 % TILE], right - x1 + 1, color);
+                plotted += right - x1 + 1;
+                x1 = right + 1;
+            }
+        }
+    };
+    std::vector<size_t> plotted(tilesY);
+    jobs.parallelFor(tilesY, 1, [&](size_t first, size_t last) {
+        for (size_t ty = first; ty < last; ty++) {
+            TileRowSink sink{ *this, color, 0 };
+            table.scan((int)ty * TILE, std::min((int)ty * TILE + TILE, h), rule, sink);
+            plotted[ty] = sink.plotted;
+        }
+    });
+    for (size_t n : plotted) drawn += n;
+}
+
+uint32_t Framebuffer::pixel(int x, int y) const {
+    size_t tile = (size_t)(y / TILE) * tilesX + x / TILE;
+    return pixels[tile * TILE * TILE + (y % TILE) * TILE + x % TILE];
+}
+
+std::vector<uint8_t> Framebuffer::rows() const {
+    std::vector<uint8_t> rgb((size_t)w * h * 3);
+    uint8_t* out = rgb.data();
+    for (int y = h - 1; y >= 0; y--) {
+        for (int x = 0; x < w; x++) {
+            uint32_t p = pixel(x, y);
+            *out++ = (uint8_t)p, *out++ = (uint8_t)(p >> 8), *out++ = (uint8_t)(p >> 16);
+        }
+    }
+    return rgb;
+}
+
+
+// IMAGE FILES
+
+bool Framebuffer::savePPM(const char* path) const {
+    std::ofstream file(path, std::ios::binary);
+    std::vector<uint8_t> rgb = rows();
+    file << "P6\n" << w << " " << h << "\n255\n";
+    file.write((const char*)rgb.data(), rgb.size());
+    return (bool)file;
+}
+
+static uint32_t Crc32(const uint8_t* data, size_t size) {
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutBigEndian(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back((uint8_t)(v >> 24)), out.push_back((uint8_t)(v >> 16));
+    out.push_back((uint8_t)(v >> 8)), out.push_back((uint8_t)v);
+}
+
+static void PutChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> chunk;
+    PutBigEndian(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    PutBigEndian(chunk, Crc32(chunk.data() + 4, chunk.size() - 4));
+    file.write((const char*)chunk.data(), chunk.size());
+}
+
+// The image data is written as uncompressed deflate blocks, which every
+// decoder reads and which needs no zlib. Files are about the size of the PPM.
+bool Framebuffer::savePNG(const char* path) const {
+    std::vector<uint8_t> rgb = rows();
+    size_t stride = (size_t)w * 3;
+
+    // every row starts with filter type 0 (none)
+    std::vector<uint8_t> raw;
+    raw.reserve((stride + 1) * h);
+    for (int y = 0; y < h; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb.begin() + y * stride, rgb.begin() + (y + 1) * stride);
+    }
+
+    std::vector<uint8_t> zlib = { 0x78, 0x01 };
+    uint32_t a = 1, b = 0;
+    size_t pos = 0;
+    do {
+        size_t n = std::min<size_t>(raw.size() - pos, 65535);
+        bool final = pos + n == raw.size();
+        zlib.push_back(final ? 1 : 0);
+        zlib.push_back((uint8_t)n), zlib.push_back((uint8_t)(n >> 8));
+        zlib.push_back((uint8_t)~n), zlib.push_back((uint8_t)(~n >> 8));
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + n);
+        for (size_t i = pos; i < pos + n; i++) {
+            a = (a + raw[i]) % 65521, b = (b + a) % 65521;
+        }
+        pos += n;
+    } while (pos < raw.size());
+    PutBigEndian(zlib, b << 16 | a);
+
+    std::vector<uint8_t> header;
+    PutBigEndian(header, (uint32_t)w), PutBigEndian(header, (uint32_t)h);
+    header.insert(header.end(), { 8, 2, 0, 0, 0 }); // 8 bit RGB, no interlace
+
+    std::ofstream file(path, std::ios::binary);
+    const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write((const char*)signature, sizeof(signature));
+    PutChunk(file, "IHDR", header);
+    PutChunk(file, "IDAT", zlib);
+    PutChunk(file, "IEND", {});
+    return (bool)file;
+}
+
+
+// DRAW CALLS
+
+void drawPoints(Framebuffer& target, const std::vector<Point>& points, float r, float g, float b, DrawMode mode) {
+    if (mode == DrawMode::Points)
+    {
+        target.drawPoints(points.data(), points.size(), r, g, b);
+        return;
+    }
+
+    std::vector<Point> pixels;
+    for (size_t i = 0; i + 1 < points.size(); i += 2) {
+        std::vector<Point> line = Bresenham(points[i].x, points[i].y, points[i + 1].x, points[i + 1].y);
+        pixels.insert(pixels.end(), line.begin(), line.end());
+    }
+    target.drawPoints(pixels.data(), pixels.size(), r, g, b);
+}
+
+void drawPoints(Framebuffer& target, const std::vector<Span>& spans, float r, float g, float b) {
+    target.drawSpans(spans.data(), spans.size(), r, g, b);
+}
+
+void drawPoints(Framebuffer& target, const std::vector<CoveragePoint>& points, float r, float g, float b) {
+    target.drawCoverage(points.data(), points.size(), r, g, b);
+}
@@ -0,0 +1,74 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include "primitives.h"
+#include "jobSystem.h"
+#include "wuLine.h"
+#include "polygonFill.h"
+
+// Software render target for machines without a GPU. Pixels are RGBA8 with R
+// in the lowest byte, stored tile by tile so every worker writes its own
+// block of memory and no two workers ever touch the same pixel.
+
+
+class Framebuffer {
+public:
+    static const int TILE = 64;
+
+    Framebuffer(int width, int height, unsigned threads = std::thread::hardware_concurrency());
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    void clear(float r, float g, float b);
+
+    // Every call bins its primitives by tile on all workers, then each tile
+    // plots its bins in submission order. Coordinates are window pixels with
+    // y up, like the GL path, and anything offscreen is dropped.
+    void drawPoints(const Point* points, size_t count, float r, float g, float b);
+    void drawSpans(const Span* spans, size_t count, float r, float g, float b);
+    // scanline fill of the closed outline through the vertices, one worker per row of tiles
+    void fillPolygon(const Point* vertices, size_t count, FillRule rule, float r, float g, float b);
+    // blends each pixel over the frame by its coverage, quantized to 8 bits
+    void drawCoverage(const CoveragePoint* points, size_t count, float r, float g, float b);
+
+    // pixel at (x, y) with y up
+    uint32_t pixel(int x, int y) const;
+
+    // top row first, the way image files store them
+    bool savePPM(const char* path) const;
+    bool savePNG(const char* path) const;
+
+    // pixels written since construction, for throughput numbers
+    size_t pixelsDrawn() const { return drawn; }
+
+    // the workers drawing runs on, idle between calls and free for other work
+    JobSystem& jobSystem() { return jobs; }
+
+private:
+    // bins[chunk * tileCount + tile], one set per binning chunk so the
+    // binning workers never share a vector
+    void resetBins(size_t chunks);
+    std::vector<uint8_t> rows() const;
+
+    int w, h, tilesX, tilesY;
+    std::vector<uint32_t> pixels;
+    std::vector<std::vector<uint32_t>> bins;
+    JobSystem jobs;
+    size_t drawn = 0;
+};
+
+
+enum class DrawMode { Points, Lines };
+
+// same calls as the GL drawPoints() in main.cpp, so a scene can be sent to
+// either target. Lines joins every pair of points with Bresenham().
+void drawPoints(Framebuffer& target, const std::vector<Point>& points, float r, float g, float b, DrawMode mode = DrawMode::Points);
+void drawPoints(Framebuffer& target, const std::vector<Span>& spans, float r, float g, float b);
+void drawPoints(Framebuffer& target, const std::vector<CoveragePoint>& points, float r, float g, float b);
+
+#endif
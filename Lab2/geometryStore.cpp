@@ -0,0 +1,113 @@
+#include "geometryStore.h"
+#include "mappedWrite.h"
+#include <algorithm>
+
+using namespace std;
+
+
+GeometryStore::~GeometryStore() {
+    release();
+}
+
+void GeometryStore::release() {
+    if (VAO)
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        VAO = VBO = 0;
+    }
+}
+
+void GeometryStore::add(const Primitive& primitive, float r, float g, float b) {
+    batch.push_back(primitive);
+    colors.push_back(PackColor(r, g, b));
+}
+
+// writes the points of every primitive to out, each primitive's points in
+// Morton order when sorted. A primitive is generated and sorted in memory
+// of our own, one primitive per worker at a time, and only its last sort
+// pass goes to out, the mapped buffer can be write-combined and slow to read.
+template <typename P>
+static void Generate(const std::vector<Primitive>& batch, const Viewport& clip, const std::vector<size_t>& offsets,
+    bool sorted, P* out, JobSystem& jobs) {
+    if (!sorted)
+    {
+        GenerateBatch(batch, clip, offsets.data(), out, jobs);
+        return;
+    }
+    jobs.parallelFor(batch.size(), 1, [&](size_t begin, size_t end) {
+        std::vector<P> points, scratch;
+        for (size_t i = begin; i < end; i++) {
+            points.resize(offsets[i + 1] - offsets[i]);
+            GeneratePrimitive(batch[i], clip, points.data());
+            MortonSort(points.data(), points.size(), scratch, out + offsets[i]);
+        }
+    });
+}
+
+void GeometryStore::upload(JobSystem& jobs) {
+    // packing rounds, so points up to half a pixel outside land on the edge of the view
+    Viewport clip = view;
+    if (packed)
+    {
+        clip = { view.xMin - 0.5f, view.yMin - 0.5f, view.xMax + 0.5f, view.yMax + 0.5f };
+    }
+    std::vector<size_t> offsets;
+    size_t total = BatchOffsets(batch, clip, offsets, jobs);
+    firsts.resize(batch.size());
+    counts.resize(batch.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+        firsts[i] = (GLint)offsets[i];
+        counts[i] = (GLsizei)(offsets[i + 1] - offsets[i]);
+    }
+    runStarts.clear();
+    for (size_t i = 0; i < batch.size(); i++) {
+        if (i == 0 || colors[i] != colors[i - 1]) runStarts.push_back(i);
+    }
+    runStarts.push_back(batch.size());
+
+    if (!VAO)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+    }
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    size_t pointSize = packed ? sizeof(PackedPoint) : sizeof(Point);
+    uploaded = total * pointSize;
+    glBufferData(GL_ARRAY_BUFFER, uploaded, NULL, GL_STATIC_DRAW);
+
+    WriteMapped(GL_ARRAY_BUFFER, 0, uploaded, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT, [&](char* dst) {
+        if (packed)
+        {
+            Generate(batch, clip, offsets, sorted, (PackedPoint*)dst, jobs);
+        }
+        else
+        {
+            Generate(batch, clip, offsets, sorted, (Point*)dst, jobs);
+        }
+    });
+
+    // unnormalized shorts reach the shader as the same whole floats
+    glVertexAttribPointer(0, 2, packed ? GL_SHORT : GL_FLOAT, GL_FALSE, (GLsizei)pointSize, (void*)0);
+    glEnableVertexAttribArray(0);
+    // location 1 stays disabled, every run sets it as a constant
+    glDisableVertexAttribArray(1);
+    glBindVertexArray(0);
+}
+
+void GeometryStore::draw(GLuint shader, float pointSize) const {
+    if (!VAO || batch.empty())
+    {
+        return;
+    }
+    glBindVertexArray(VAO);
+    glUseProgram(shader);
+    glPointSize(pointSize);
+    for (size_t r = 0; r + 1 < runStarts.size(); r++) {
+        size_t first = runStarts[r];
+        uint32_t c = colors[first];
+        glVertexAttrib4Nub(1, c & 0xFF, c >> 8 & 0xFF, c >> 16 & 0xFF, c >> 24);
+        glMultiDrawArrays(GL_POINTS, firsts.data() + first, counts.data() + first, (GLsizei)(runStarts[r + 1] - first));
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef GEOMETRY_STORE_H
+#define GEOMETRY_STORE_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "primitiveBatch.h"
+#include "mortonOrder.h"
+
+// Primitives that never change, kept on the GPU. They all live in one buffer,
+// the positions of every primitive back to back. Colors stay out of the
+// buffer: primitives added one after another with the same color form a
+// run, and a frame draws each run with one glMultiDrawArrays and its color
+// as a constant attribute. Nothing is created, uploaded or deleted per frame.
+class GeometryStore {
+public:
+    GeometryStore() = default;
+    ~GeometryStore();
+    GeometryStore(const GeometryStore&) = delete;
+    GeometryStore& operator=(const GeometryStore&) = delete;
+
+    // queues a primitive, nothing reaches the GPU before upload()
+    void add(const Primitive& primitive, float r, float g, float b);
+
+    // only points inside view are generated and uploaded, the window by default
+    void clipTo(const Viewport& v) { view = v; }
+
+    // positions as PackedPoint, 4 bytes a point instead of 8. Points are
+    // rounded to the nearest pixel, which only moves off-pixel primitives.
+    void packPoints(bool on) { packed = on; }
+
+    // every primitive's points in Morton order (mortonOrder.h), neighbours
+    // on screen next to each other in the buffer
+    void mortonOrder(bool on) { sorted = on; }
+
+    // generates every queued primitive straight into a new buffer
+    void upload(JobSystem& jobs);
+
+    // draws every primitive as points in the order they were added, the
+    // shader takes the position at location 0 and the color at location 1
+    void draw(GLuint shader, float pointSize) const;
+
+    // deletes the GL objects, needs the context to still be current
+    void release();
+
+    size_t size() const { return batch.size(); }
+    // where primitive i starts in the buffer and how many points it has
+    GLint first(size_t i) const { return firsts[i]; }
+    GLsizei count(size_t i) const { return counts[i]; }
+    // size of the uploaded buffer, positions only
+    size_t bytes() const { return uploaded; }
+    // draw calls a frame takes, one per run of same-colored primitives
+    size_t runs() const { return runStarts.empty() ? 0 : runStarts.size() - 1; }
+
+private:
+    std::vector<Primitive> batch;
+    std::vector<uint32_t> colors;   // R in the lowest byte
+    std::vector<GLint> firsts;
+    std::vector<GLsizei> counts;
+    std::vector<size_t> runStarts;  // first primitive of every run, then size()
+    Viewport view = SCREEN_VIEWPORT;
+    bool packed = false, sorted = false;
+    size_t uploaded = 0;
+    GLuint VAO = 0, VBO = 0;
+};
+
+#endif
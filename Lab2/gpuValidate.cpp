@@ -0,0 +1,137 @@
+#include <glad/glad.h>
+#include <iostream>
+#include <vector>
+#include <random>
+#include "primitives.h"
+#include "procedural.h"
+#include "headlessGL.h"
+
+using namespace std;
+
+// Runs proceduralVertexShaderSource on a headless GL context and checks every
+// point it makes against MidpointCircle() and MidpointEllipse() on the CPU.
+// The points are read back with transform feedback and nothing is
+// rasterized. Meant for a software driver such as Mesa llvmpipe:
+//   g++ -O2 -std=c++17 -I../LIBRARIES/include gpuValidate.cpp headlessGL.cpp procedural.cpp viewportClip.cpp primitives.cpp jobSystem.cpp "../Index element/glad.c" -lEGL -ldl -pthread -o gpuValidate
+//   EGL_PLATFORM=surfaceless ./gpuValidate
+
+
+static GLuint CreateFeedbackProgram() {
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &proceduralVertexShaderSource, NULL);
+    glCompileShader(vertexShader);
+    GLint success;
+    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    const char* varyings[] = { "point" };
+    glTransformFeedbackVaryings(program, 1, varyings, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        return 0;
+    }
+    return program;
+}
+
+// draws the shape with rasterization off and returns the points the shader made
+static std::vector<Point> RunShader(GLuint program, GLuint feedbackBuffer, const ProceduralShape& shape) {
+    std::vector<Point> points(shape.count);
+    if (shape.count == 0)
+    {
+        return points;
+    }
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, feedbackBuffer);
+    glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, shape.count * sizeof(Point), NULL, GL_STREAM_READ);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, feedbackBuffer);
+
+    setProceduralUniforms(program, shape);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, (GLsizei)shape.count);
+    glEndTransformFeedback();
+    glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, shape.count * sizeof(Point), points.data());
+    return points;
+}
+
+static bool Same(const std::vector<Point>& gpu, const std::vector<Point>& cpu) {
+    if (gpu.size() != cpu.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < gpu.size(); i++) {
+        if (gpu[i].x != cpu[i].x || gpu[i].y != cpu[i].y) return false;
+    }
+    return true;
+}
+
+int main() {
+    if (!CreateHeadlessContext())
+    {
+        std::cout << "Failed to create a headless GL context" << std::endl;
+        return 1;
+    }
+    std::cout << glGetString(GL_RENDERER) << " | " << glGetString(GL_VERSION) << std::endl;
+
+    GLuint program = CreateFeedbackProgram();
+    if (!program)
+    {
+        return 1;
+    }
+    // nothing is rasterized, but draws still need a complete framebuffer
+    CreateRenderTarget(1, 1);
+    GLuint VAO, feedbackBuffer;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    glGenBuffers(1, &feedbackBuffer);
+    glEnable(GL_RASTERIZER_DISCARD);
+
+    std::mt19937 random(2024);
+    std::uniform_int_distribution<int> radius(0, 32767);
+    const float xc = 500, yc = 500;
+    size_t shapes = 0, points = 0, mismatches = 0;
+    auto check = [&](const ProceduralShape& shape, const std::vector<Point>& cpu, const char* what) {
+        shapes++, points += cpu.size();
+        if (!Same(RunShader(program, feedbackBuffer, shape), cpu))
+        {
+            mismatches++;
+            std::cout << "mismatch: " << what << " " << shape.rx << " " << shape.ry << std::endl;
+        }
+    };
+
+    for (int r = 0; r <= 2000; r++) {
+        check(ProceduralCircle(xc, yc, (float)r), MidpointCircle(xc, yc, (float)r), "circle");
+    }
+    for (int i = 0; i < 200; i++) {
+        float r = (float)radius(random);
+        check(ProceduralCircle(xc, yc, r), MidpointCircle(xc, yc, r), "circle");
+    }
+    for (int rx = 0; rx <= 120; rx++) {
+        for (int ry = 0; ry <= 120; ry++) {
+            check(ProceduralEllipse(xc, yc, (float)rx, (float)ry), MidpointEllipse(xc, yc, (float)rx, (float)ry), "ellipse");
+        }
+    }
+    for (int i = 0; i < 2000; i++) {
+        float rx = (float)radius(random), ry = (float)radius(random);
+        if (i % 2) rx = (float)(radius(random) % 200);
+        check(ProceduralEllipse(xc, yc, rx, ry), MidpointEllipse(xc, yc, rx, ry), "ellipse");
+    }
+
+    glDeleteBuffers(1, &feedbackBuffer);
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteProgram(program);
+    std::cout << shapes << " shapes, " << points << " points, " << mismatches << " mismatches" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
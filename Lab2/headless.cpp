@@ -0,0 +1,116 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include "primitives.h"
+#include "viewportClip.h"
+#include "framebuffer.h"
+#include "primitiveBatch.h"
+#include "primitiveFile.h"
+
+using namespace std;
+
+// Draws the same scene as main.cpp into the software framebuffer and writes
+// it to <name>.ppm and <name>.png, for machines without a GPU or a display.
+// Like main.cpp it only generates the pixels inside the window.
+// Usage: Lab2Headless [name] [threads] [primitive file]. Without a file the
+// shapes are read from stdin, see primitiveFile.h for the file formats.
+
+static const char* USAGE = "usage: Lab2Headless [name] [threads] [primitive file]";
+
+
+typedef std::chrono::steady_clock Clock;
+
+static int Save(const Framebuffer& target, const std::string& name) {
+    if (!target.savePPM((name + ".ppm").c_str()) || !target.savePNG((name + ".png").c_str()))
+    {
+        std::cerr << "could not write " << name << ".ppm/.png" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// the points of p inside the window
+static std::vector<Point> Clipped(const Primitive& p) {
+    std::vector<Point> points(PrimitiveCount(p, SCREEN_VIEWPORT));
+    GeneratePrimitive(p, SCREEN_VIEWPORT, points.data());
+    return points;
+}
+
+int main(int argc, char** argv) {
+    std::string name = argc > 1 ? argv[1] : "lab2";
+    unsigned threads = std::thread::hardware_concurrency();
+    if (argc > 2)
+    {
+        const char* end = argv[2] + std::strlen(argv[2]);
+        std::from_chars_result result = std::from_chars(argv[2], end, threads);
+        if (result.ec != std::errc() || result.ptr != end)
+        {
+            std::cerr << argv[2] << ": not a thread count\n" << USAGE << std::endl;
+            return 1;
+        }
+    }
+    threads = std::max(1u, threads);
+
+    if (argc > 3)
+    {
+        // everything in the file goes through the batch generator, drawn in
+        // the colors main.cpp gives each type
+        PrimitiveFile file;
+        if (!file.open(argv[3]))
+        {
+            std::cerr << argv[3] << ": " << file.error() << std::endl;
+            return 1;
+        }
+        std::cout << file.size() << " primitives, " << file.bytes() / 1e6 << " MB loaded in "
+            << file.seconds() * 1e3 << " ms, " << file.megabytesPerSecond() << " MB/s\n";
+
+        Framebuffer target(WIDTH, HEIGHT, threads);
+        JobSystem& jobs = target.jobSystem();
+        Clock::time_point start = Clock::now();
+        std::vector<size_t> offsets;
+        std::vector<Point> points(BatchOffsets(file.data(), file.size(), SCREEN_VIEWPORT, offsets, jobs));
+        GenerateBatch(file.data(), file.size(), SCREEN_VIEWPORT, offsets.data(), points.data(), jobs);
+        target.clear(0.1f, 0.1f, 0.1f);
+        drawPoints(target, createCoordinateAxes(), 1.0f, 1.0f, 1.0f, DrawMode::Lines);
+        // a run of primitives of one type is one draw, in file order like the GL store
+        const float colors[4][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 0.0f } };
+        for (size_t begin = 0, end; begin < file.size(); begin = end) {
+            PrimitiveType type = file.data()[begin].type;
+            for (end = begin + 1; end < file.size() && file.data()[end].type == type; end++);
+            const float* color = colors[(int)type];
+            target.drawPoints(points.data() + offsets[begin], offsets[end] - offsets[begin], color[0], color[1], color[2]);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << points.size() << " points generated and drawn in " << seconds * 1e3 << " ms\n";
+        return Save(target, name);
+    }
+
+    float x1d, y1d, x2d, y2d, x1b, y1b, x2b, y2b; // line coordinates
+    float xc, yc, r; // circle parameters
+    float xe, ye, rx, ry; // ellipse parameters
+    if (!(std::cin >> x1d >> y1d >> x2d >> y2d >> x1b >> y1b >> x2b >> y2b >> xc >> yc >> r >> xe >> ye >> rx >> ry))
+    {
+        std::cerr << "expected x1d y1d x2d y2d  x1b y1b x2b y2b  xc yc r  xe ye rx ry on stdin" << std::endl;
+        return 1;
+    }
+
+    Framebuffer target(WIDTH, HEIGHT, threads);
+    Clock::time_point start = Clock::now();
+
+    target.clear(0.1f, 0.1f, 0.1f);
+    drawPoints(target, createCoordinateAxes(), 1.0f, 1.0f, 1.0f, DrawMode::Lines);
+    drawPoints(target, DDASpans(x1d+500, y1d+500, x2d+500, y2d+500, SCREEN_VIEWPORT), 1.0f, 0.0f, 0.0f); // red DDA
+    drawPoints(target, BresenhamSpans(x1b+500, y1b+500, x2b+500, y2b+500, SCREEN_VIEWPORT), 0.0f, 1.0f, 0.0f); // green bresenham
+    drawPoints(target, Clipped({ PrimitiveType::Circle, xc+500, yc+500, r, 0 }), 0.0f, 0.0f, 1.0f); // blue circle
+    drawPoints(target, Clipped({ PrimitiveType::Ellipse, xe+500, ye+500, rx, ry }), 1.0f, 1.0f, 0.0f); // yellow ellipse
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << target.pixelsDrawn() << " pixels in " << seconds * 1e3 << " ms, "
+        << target.pixelsDrawn() / seconds / 1e6 << " Mpixels/s on " << threads << " thread(s)\n";
+
+    return Save(target, name);
+}
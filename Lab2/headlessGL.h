@@ -0,0 +1,15 @@
+#ifndef HEADLESS_GL_H
+#define HEADLESS_GL_H
+
+#include <glad/glad.h>
+
+// GL 3.3 core context without a window or display, through EGL's
+// surfaceless platform (run with EGL_PLATFORM=surfaceless on Mesa).
+// Linux only, for the command line GL tools.
+bool CreateHeadlessContext();
+
+// A surfaceless context has no default framebuffer, so this makes and binds
+// an RGBA8 one of the given size. Returns the framebuffer.
+GLuint CreateRenderTarget(int width, int height);
+
+#endif
@@ -0,0 +1,180 @@
+#include "jobSystem.h"
+#include <algorithm>
+
+using namespace std;
+
+
+JobSystem::JobSystem(unsigned count) {
+    count = std::max(count, 1u);
+    for (unsigned i = 0; i < count; i++) {
+        queues.emplace_back(new Queue());
+    }
+    for (unsigned i = 1; i < count; i++) {
+        threads.emplace_back(&JobSystem::work, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads) {
+        t.join();
+    }
+}
+
+void JobSystem::parallelFor(size_t n, size_t g, const std::function<void(size_t, size_t)>& fn) {
+    g = std::max<size_t>(g, 1);
+    if (threads.empty() || n <= g)
+    {
+        for (size_t i = 0; i < n; i += g) fn(i, std::min(n, i + g));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        body = &fn, grain = g, remaining = n;
+        size_t workers = queues.size();
+        for (size_t w = 0; w < workers; w++) {
+            Range share = { n * w / workers, n * (w + 1) / workers };
+            if (share.begin < share.end)
+            {
+                std::lock_guard<std::mutex> queueLock(queues[w]->lock);
+                queues[w]->ranges.push_back(share);
+            }
+        }
+        busy = (unsigned)threads.size();
+        generation++;
+    }
+    wake.notify_all();
+    runRanges(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return busy == 0; });
+}
+
+void JobSystem::work(unsigned worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+        }
+        runRanges(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) done.notify_one();
+        }
+    }
+}
+
+void JobSystem::runRanges(unsigned worker) {
+    while (remaining > 0) {
+        uint64_t seen = pushed;
+        Range range;
+        if (!pop(worker, range) && !steal(worker, range))
+        {
+            // the last ranges are still running elsewhere, sleep until one
+            // of them is split into the queues or all of them are done
+            std::unique_lock<std::mutex> lock(mutex);
+            waiting++;
+            more.wait(lock, [&] { return pushed != seen || remaining == 0; });
+            waiting--;
+            continue;
+        }
+
+        bool split = false;
+        while (range.end - range.begin > grain) {
+            size_t mid = range.begin + (range.end - range.begin) / 2;
+            {
+                std::lock_guard<std::mutex> lock(queues[worker]->lock);
+                queues[worker]->ranges.push_back({ mid, range.end });
+            }
+            range.end = mid;
+            split = true;
+        }
+        if (split)
+        {
+            pushed++;
+            notifyWaiting();
+        }
+        (*body)(range.begin, range.end);
+        if ((remaining -= range.end - range.begin) == 0)
+        {
+            notifyWaiting();
+        }
+    }
+}
+
+void JobSystem::notifyWaiting() {
+    // waiters count themselves before they check, and the counters are
+    // sequentially consistent, so either they see the change or we see them
+    if (waiting > 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        more.notify_all();
+    }
+}
+
+bool JobSystem::pop(unsigned worker, Range& range) {
+    Queue& own = *queues[worker];
+    std::lock_guard<std::mutex> lock(own.lock);
+    if (own.ranges.empty())
+    {
+        return false;
+    }
+    range = own.ranges.back();
+    own.ranges.pop_back();
+    return true;
+}
+
+bool JobSystem::steal(unsigned worker, Range& range) {
+    for (size_t i = 1; i < queues.size(); i++) {
+        Queue& victim = *queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.lock);
+        if (!victim.ranges.empty())
+        {
+            range = victim.ranges.front();
+            victim.ranges.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+
+size_t ParallelExclusiveScan(const size_t* in, size_t* out, size_t n, JobSystem& jobs) {
+    // sum fixed blocks in parallel, scan the block sums, then let every
+    // block write its own part starting from its sum
+    size_t blocks = std::max<size_t>(1, std::min<size_t>(n, jobs.size() * 4));
+    std::vector<size_t> sums(blocks + 1);
+    auto blockRange = [&](size_t b) { return std::make_pair(n * b / blocks, n * (b + 1) / blocks); };
+
+    jobs.parallelFor(blocks, 1, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; b++) {
+            size_t sum = 0;
+            for (size_t i = blockRange(b).first; i < blockRange(b).second; i++) sum += in[i];
+            sums[b + 1] = sum;
+        }
+    });
+    for (size_t b = 0; b < blocks; b++) {
+        sums[b + 1] += sums[b];
+    }
+
+    jobs.parallelFor(blocks, 1, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; b++) {
+            size_t running = sums[b];
+            for (size_t i = blockRange(b).first; i < blockRange(b).second; i++) {
+                size_t value = in[i];
+                out[i] = running;
+                running += value;
+            }
+        }
+    });
+    out[n] = sums[blocks];
+    return sums[blocks];
+}
@@ -0,0 +1,67 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// Work stealing parallel for. Every worker owns a queue of index ranges and
+// starts with an equal share. A worker halves its range until it is no
+// larger than the grain, keeping the front half and queueing the back half,
+// and once its own queue is empty it steals the oldest (largest) range from
+// another worker. Uneven work, like a batch whose primitives differ widely in
+// length, ends up spread over all workers this way. A single index is never
+// split though, so one primitive larger than all the rest together still
+// runs on one worker. Workers without anything left to take sleep until a
+// range is split or the loop is done.
+class JobSystem {
+public:
+    explicit JobSystem(unsigned threads = std::thread::hardware_concurrency());
+    ~JobSystem();
+
+    // number of workers, including the calling thread
+    unsigned size() const { return (unsigned)queues.size(); }
+
+    // calls body(begin, end) on ranges covering [0, n) of at most grain
+    // indices each, and returns once all of them are done
+    void parallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+private:
+    struct Range { size_t begin, end; };
+    struct Queue {
+        std::mutex lock;
+        std::deque<Range> ranges;
+    };
+
+    void work(unsigned worker);
+    void runRanges(unsigned worker);
+    bool pop(unsigned worker, Range& range);
+    bool steal(unsigned worker, Range& range);
+    void notifyWaiting();
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake, done, more;
+    const std::function<void(size_t, size_t)>* body = nullptr;
+    size_t grain = 1;
+    std::atomic<size_t> remaining{ 0 };
+    std::atomic<uint64_t> pushed{ 0 };      // ranges queued by splitting
+    std::atomic<unsigned> waiting{ 0 };     // workers asleep on more
+    unsigned busy = 0;
+    uint64_t generation = 0;
+    bool quit = false;
+};
+
+// exclusive prefix sum of in[0..n) into out[0..n], out[n] gets the total,
+// which is also returned. in and out may be the same array.
+size_t ParallelExclusiveScan(const size_t* in, size_t* out, size_t n, JobSystem& jobs);
+
+#endif
@@ -0,0 +1,64 @@
+#include "layerStore.h"
+#include "mappedWrite.h"
+
+using namespace std;
+
+
+LayerStore::~LayerStore() {
+    release();
+}
+
+void LayerStore::release() {
+    if (VAO)
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        VAO = VBO = 0;
+    }
+}
+
+void LayerStore::upload(JobSystem& jobs) {
+    pixels.rasterize(jobs);
+    firsts.resize(pixels.layers() + 1);
+    total = 0;
+    for (size_t i = 0; i < pixels.layers(); i++) {
+        firsts[i] = (GLint)total;
+        total += pixels.unique(i);
+    }
+    firsts[pixels.layers()] = (GLint)total;
+
+    if (!VAO)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+    }
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, total * sizeof(PackedPoint), NULL, GL_STATIC_DRAW);
+    // compacting the masks again gives the same pixels, as WriteMapped needs
+    WriteMapped(GL_ARRAY_BUFFER, 0, total * sizeof(PackedPoint), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT, [&](char* dst) {
+        for (size_t i = 0; i < pixels.layers(); i++) {
+            pixels.compact(i, (PackedPoint*)dst + firsts[i], jobs);
+        }
+    });
+    glVertexAttribPointer(0, 2, GL_SHORT, GL_FALSE, sizeof(PackedPoint), (void*)0);
+    glEnableVertexAttribArray(0);
+    // location 1 stays disabled, every draw sets it as a constant
+    glDisableVertexAttribArray(1);
+    glBindVertexArray(0);
+}
+
+void LayerStore::draw(GLuint shader, float pointSize) const {
+    if (!VAO || total == 0)
+    {
+        return;
+    }
+    glBindVertexArray(VAO);
+    glUseProgram(shader);
+    glPointSize(pointSize);
+    for (size_t i = 0; i < pixels.layers(); i++) {
+        uint32_t c = pixels.color(i);
+        glVertexAttrib4Nub(1, c & 0xFF, c >> 8 & 0xFF, c >> 16 & 0xFF, c >> 24);
+        glDrawArrays(GL_POINTS, firsts[i], firsts[i + 1] - firsts[i]);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef LAYER_STORE_H
+#define LAYER_STORE_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include "occupancy.h"
+
+// A GeometryStore for scenes that overlap a lot: the primitives go through
+// OccupancyLayers and only the unique pixels of each color are uploaded, as
+// PackedPoint. The color is the same for a whole layer, so it is set once
+// per draw instead of stored per point.
+class LayerStore {
+public:
+    explicit LayerStore(const Viewport& view = SCREEN_VIEWPORT) : pixels(view) {}
+    ~LayerStore();
+    LayerStore(const LayerStore&) = delete;
+    LayerStore& operator=(const LayerStore&) = delete;
+
+    // queues a primitive, nothing reaches the GPU before upload()
+    void add(const Primitive& primitive, float r, float g, float b) { pixels.add(primitive, r, g, b); }
+
+    // rasterizes every layer and uploads their pixels into a new buffer
+    void upload(JobSystem& jobs);
+
+    // one draw per layer in the order the colors first appeared. Takes the
+    // same shader as GeometryStore, position at location 0 and color at 1.
+    // Where layers overlap the later layer wins, not the later primitive.
+    void draw(GLuint shader, float pointSize) const;
+
+    // deletes the GL objects, needs the context to still be current
+    void release();
+
+    const OccupancyLayers& layers() const { return pixels; }
+    // pixels uploaded, and the size of the buffer
+    size_t points() const { return total; }
+    size_t bytes() const { return total * sizeof(PackedPoint); }
+
+private:
+    OccupancyLayers pixels;
+    std::vector<GLint> firsts;
+    size_t total = 0;
+    GLuint VAO = 0, VBO = 0;
+};
+
+#endif
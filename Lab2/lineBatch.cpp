@@ -0,0 +1,71 @@
+#include "lineBatch.h"
+#include "simd.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+
+size_t DDABatchOffsets(const LineBatch& lines, std::vector<size_t>& offsets) {
+    offsets.resize(lines.size() + 1);
+    size_t total = 0;
+    for (size_t i = 0; i < lines.size(); i++) {
+        offsets[i] = total;
+        total += DDACount(lines.x1[i], lines.y1[i], lines.x2[i], lines.y2[i]);
+    }
+    offsets[lines.size()] = total;
+    return total;
+}
+
+#if defined(SIMD_AVX2) || defined(SIMD_SSE2)
+// walks LANES lines in lockstep until the longest one is done,
+// shorter lines simply stop writing
+static void DDAGroup(const LineBatch& lines, size_t first, const size_t* offsets, Point* out) {
+    typedef Simd::V V;
+    const int N = Simd::LANES;
+
+    V x = Simd::load(&lines.x1[first]), y = Simd::load(&lines.y1[first]);
+    V dx = Simd::sub(Simd::load(&lines.x2[first]), x);
+    V dy = Simd::sub(Simd::load(&lines.y2[first]), y);
+    V steps = Simd::max(Simd::abs(dx), Simd::abs(dy));
+    V xInc = Simd::div(dx, steps), yInc = Simd::div(dy, steps);
+
+    size_t count[N], maxCount = 0;
+    Point* dst[N];
+    for (int l = 0; l < N; l++) {
+        count[l] = offsets[first + l + 1] - offsets[first + l];
+        dst[l] = out + offsets[first + l];
+        maxCount = std::max(maxCount, count[l]);
+    }
+
+    float rx[N], ry[N];
+    for (size_t i = 0; i < maxCount; i++) {
+        Simd::store(rx, Simd::round(x));
+        Simd::store(ry, Simd::round(y));
+        for (int l = 0; l < N; l++) {
+            if (i < count[l])
+            {
+                dst[l][i] = { rx[l], ry[l] };
+            }
+        }
+        x = Simd::add(x, xInc); y = Simd::add(y, yInc);
+    }
+}
+#endif
+
+void DDABatch(const LineBatch& lines, const size_t* offsets, Point* out) {
+    size_t i = 0;
+#if defined(SIMD_AVX2) || defined(SIMD_SSE2)
+    for (; i + Simd::LANES <= lines.size(); i += Simd::LANES) {
+        DDAGroup(lines, i, offsets, out);
+    }
+#endif
+    for (; i < lines.size(); i++) {
+        BufferSink sink(out + offsets[i]);
+        DDA(lines.x1[i], lines.y1[i], lines.x2[i], lines.y2[i], sink);
+    }
+}
+
+const char* DDABatchISA() {
+    return SimdISA();
+}
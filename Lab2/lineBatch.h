@@ -0,0 +1,30 @@
+#ifndef LINE_BATCH_H
+#define LINE_BATCH_H
+
+#include <vector>
+#include <cstddef>
+#include "primitives.h"
+
+// structure-of-arrays line list, so the batch kernels can load the same
+// coordinate of several lines with one instruction
+struct LineBatch {
+    std::vector<float> x1, y1, x2, y2;
+
+    void add(float ax, float ay, float bx, float by) {
+        x1.push_back(ax), y1.push_back(ay), x2.push_back(bx), y2.push_back(by);
+    }
+    size_t size() const { return x1.size(); }
+};
+
+// fills offsets[0..n] with the start of every line in the output buffer
+// and returns the total number of points the batch produces
+size_t DDABatchOffsets(const LineBatch& lines, std::vector<size_t>& offsets);
+
+// steps 8 (AVX2) or 4 (SSE2) lines at a time, writing every line to
+// out + offsets[i]. The pixels match DDA() exactly.
+void DDABatch(const LineBatch& lines, const size_t* offsets, Point* out);
+
+// name of the instruction set DDABatch was compiled for
+const char* DDABatchISA();
+
+#endif
@@ -0,0 +1,49 @@
+#include "linePattern.h"
+
+using namespace std;
+
+
+PatternRuns ExpandPattern(const LinePattern& pattern) {
+    PatternRuns runs = {};
+    int length = std::min(std::max(pattern.length, 1), 32);
+    int64_t scale = std::max(pattern.scale, 1);
+    runs.period = length * scale;
+    for (int i = 0; i < length; i++) {
+        if (!(pattern.bits >> i & 1))
+        {
+            continue;
+        }
+        // a set bit right after the last one only grows that run
+        if (runs.count > 0 && runs.end[runs.count - 1] == i * scale - 1)
+        {
+            runs.end[runs.count - 1] += scale;
+            continue;
+        }
+        runs.start[runs.count] = i * scale;
+        runs.end[runs.count] = (i + 1) * scale - 1;
+        runs.count++;
+    }
+    return runs;
+}
+
+static size_t CountRuns(const BresenhamClip& c, const LinePattern& pattern) {
+    size_t n = 0;
+    int64_t tMin = c.reversed ? c.dx - c.last : c.first, tMax = c.reversed ? c.dx - c.first : c.last;
+    ForPatternRuns(ExpandPattern(pattern), tMin, tMax, [&](int64_t t0, int64_t t1) { n += (size_t)(t1 - t0 + 1); });
+    return n;
+}
+
+size_t PatternedBresenhamCount(float x1, float y1, float x2, float y2, const LinePattern& pattern) {
+    return CountRuns(BresenhamWalk(llround(x1), llround(y1), llround(x2), llround(y2)), pattern);
+}
+
+size_t PatternedBresenhamCount(float x1, float y1, float x2, float y2, const LinePattern& pattern, const Viewport& view) {
+    return CountRuns(ClipBresenham(llround(x1), llround(y1), llround(x2), llround(y2), view), pattern);
+}
+
+std::vector<Point> PatternedBresenham(float x1, float y1, float x2, float y2, const LinePattern& pattern) {
+    std::vector<Point> points(PatternedBresenhamCount(x1, y1, x2, y2, pattern));
+    BufferSink sink(points.data());
+    PatternedBresenham(x1, y1, x2, y2, pattern, sink);
+    return points;
+}
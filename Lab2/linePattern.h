@@ -0,0 +1,86 @@
+#ifndef LINE_PATTERN_H
+#define LINE_PATTERN_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "primitives.h"
+#include "viewportClip.h"
+
+// Dashed and dotted lines drawn by the integer Bresenham walk. The pattern
+// counts steps along the major axis from the first end point, like
+// glLineStipple: bit i covers steps i * scale .. (i + 1) * scale - 1 of
+// every period of length * scale steps. Only the drawn runs are walked.
+// The walk jumps to the start of each run with the closed form of its
+// error term, so a line costs its drawn pixels plus one jump per dash,
+// however long the gaps between them are.
+
+struct LinePattern {
+    uint32_t bits;      // bit 0 comes first
+    int length;         // bits used, 1 to 32
+    int scale;          // steps per bit
+};
+
+const LinePattern DASHED_LINE = { 0xFF, 16, 1 };    // 8 on, 8 off
+const LinePattern DOTTED_LINE = { 0x1, 4, 1 };      // 1 on, 3 off
+const LinePattern DASH_DOT_LINE = { 0x47F, 16, 1 }; // 7 on, 3 off, 1 on, 5 off
+
+// the drawn runs of one period, in steps from its start
+struct PatternRuns {
+    int64_t period;
+    int count;
+    int64_t start[16], end[16];     // 32 bits hold at most 16 runs
+};
+PatternRuns ExpandPattern(const LinePattern& pattern);
+
+// calls run(t0, t1) for every drawn run of steps t0..t1 inside tMin..tMax,
+// t counting from the line's first end point
+template <typename Run>
+void ForPatternRuns(const PatternRuns& runs, int64_t tMin, int64_t tMax, Run run) {
+    if (runs.count == 0 || tMin > tMax)
+    {
+        return;
+    }
+    for (int64_t base = tMin - tMin % runs.period; base <= tMax; base += runs.period) {
+        for (int i = 0; i < runs.count && base + runs.start[i] <= tMax; i++) {
+            int64_t t0 = std::max(base + runs.start[i], tMin), t1 = std::min(base + runs.end[i], tMax);
+            if (t0 <= t1) run(t0, t1);
+        }
+    }
+}
+
+// the visible steps of c that the pattern draws. A reversed walk counts
+// the pattern from its far end, which is the line's first end point.
+template <typename Sink>
+void PatternedWalk(const BresenhamClip& c, const LinePattern& pattern, Sink& sink) {
+    PatternRuns runs = ExpandPattern(pattern);
+    if (!c.reversed)
+    {
+        ForPatternRuns(runs, c.first, c.last, [&](int64_t t0, int64_t t1) { BresenhamRun(c, t0, t1, sink); });
+    }
+    else
+    {
+        ForPatternRuns(runs, c.dx - c.last, c.dx - c.first, [&](int64_t t0, int64_t t1) { BresenhamRun(c, c.dx - t1, c.dx - t0, sink); });
+    }
+}
+
+// the pixels of Bresenham<LineMath::Integer>() that the pattern draws
+template <typename Sink>
+void PatternedBresenham(float x1, float y1, float x2, float y2, const LinePattern& pattern, Sink& sink) {
+    PatternedWalk(BresenhamWalk(std::llround(x1), std::llround(y1), std::llround(x2), std::llround(y2)), pattern, sink);
+}
+
+// the same, only the pixels inside view
+template <typename Sink>
+void PatternedBresenham(float x1, float y1, float x2, float y2, const LinePattern& pattern, const Viewport& view, Sink& sink) {
+    PatternedWalk(ClipBresenham(std::llround(x1), std::llround(y1), std::llround(x2), std::llround(y2), view), pattern, sink);
+}
+
+// exact number of points, one step per drawn run
+size_t PatternedBresenhamCount(float x1, float y1, float x2, float y2, const LinePattern& pattern);
+size_t PatternedBresenhamCount(float x1, float y1, float x2, float y2, const LinePattern& pattern, const Viewport& view);
+
+std::vector<Point> PatternedBresenham(float x1, float y1, float x2, float y2, const LinePattern& pattern);
+
+#endif
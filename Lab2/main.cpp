@@ -3,6 +3,18 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <chrono>
+#include "primitives.h"
+#include "wuLine.h"
+#include "primitiveBatch.h"
+#include "viewportClip.h"
+#include "procedural.h"
+#include "geometryStore.h"
+#include "spanStore.h"
+#include "primitiveFile.h"
+#include "pointStream.h"
+#include "uploadRing.h"
+#include "linePattern.h"
 
 using namespace std;
 
@@ -23,131 +35,107 @@ const char* vertexShaderSource = R"glsl(
 
 
 
-const char* fragmentShaderSource = R"glsl(
+// span mode: one unit quad per run, stretched over the run in the shader;
+// the color comes with every instance so all spans draw in one call
+const char* spanVertexShaderSource = R"glsl(
     #version 330 core
-    out vec4 FragColor;
-    uniform vec3 color;
+    layout (location = 0) in vec2 aCorner;
+    layout (location = 1) in vec4 aSpan;
+    layout (location = 2) in vec4 aColor;
+    out vec4 pointColor;
+
     void main() {
-        FragColor = vec4(color, 1.0);
+        // grow the run by one pixel on each side to match the 2px points
+        vec2 pos = mix(aSpan.xy - 1.0, aSpan.zw + 1.0, aCorner);
+        gl_Position = vec4((pos - 500.0) / 500.0, 0.0, 1.0);
+        pointColor = aColor;
     }
 )glsl";
 
-// window size
-const int WIDTH = 1000;
-const int HEIGHT = 1000;
+// draw lines as runs instead of single pixels
+const bool USE_SPANS = true;
 
-// 2D point structure datatype
-struct Point { float x, y; };
+// draw the circle and ellipse filled, one span per row
+const bool FILL_SHAPES = false;
 
+// compute the circle and ellipse points in the vertex shader instead of
+// uploading them, see procedural.h
+const bool PROCEDURAL_SHAPES = false;
 
+// generate the circle and ellipse lazily every frame and draw them through
+// a fixed upload ring, memory stays at the ring size whatever the radius
+const bool STREAM_SHAPES = false;
 
-// ALGORITHMS
+// upload the stored points as int16 pairs, half the bytes of float pairs
+const bool PACK_POINTS = true;
 
-// Function to draw coordinate axes
-std::vector<Point> createCoordinateAxes() {
-    return {
-        {0, HEIGHT / 2}, {WIDTH, HEIGHT / 2},  // X-axis
-        {WIDTH / 2, 0}, {WIDTH / 2, HEIGHT}     // Y-axis
-    };
-}
+// store every primitive's points in Morton order, see mortonOrder.h. Off:
+// the sort costs more at upload than the bench shows it saving on a
+// window-sized scene
+const bool MORTON_ORDER = false;
 
-std::vector<Point> DDA(float x1, float y1, float x2, float y2) {
-    std::vector<Point> points;
-    float dx = x2 - x1, dy = y2 - y1;
-    float steps = std::max(abs(dx), abs(dy));
-    float xInc = dx / steps, yInc = dy / steps;
-    float x = x1, y = y1;
+// dashed grid lines every 100 pixels under the scene, see linePattern.h
+const bool GRID_LINES = true;
 
-    for (int i = 0; i <= steps; i++) {
-        points.push_back({ round(x), round(y) });
-        x += xInc; y += yInc;
-    }
-    return points;
-}
 
-std::vector<Point> Bresenham(float x1, float y1, float x2, float y2) {
-    std::vector<Point> points;
-    float dx = abs(x2 - x1), dy = abs(y2 - y1);
-    bool steep = dy > dx;
-    if (steep) 
-    {
-        std::swap(x1, y1), std::swap(x2, y2), std::swap(dx, dy);
-    }
-    if (x1 > x2)
-    {
-        std::swap(x1, x2), std::swap(y1, y2);
-    }
+// antialiased lines: single pixel points with the coverage as alpha
+const char* coverageVertexShaderSource = R"glsl(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in float aCoverage;
+    out float coverage;
 
-    float y = y1, p = 2 * dy - dx;
-    for (float x = x1; x <= x2; x++) {
-        points.push_back(steep ? Point{ y, x } : Point{ x, y });
-        if (p >= 0) y += (y2 > y1 ? 1 : -1), p -= 2 * dx;
-        p += 2 * dy;
+    void main() {
+        // one pixel per point, so aim at the pixel centre
+        gl_Position = vec4((aPos + 0.5 - 500.0) / 500.0, 0.0, 1.0);
+        coverage = aCoverage;
     }
-    return points;
-}
+)glsl";
 
-std::vector<Point> MidpointCircle(float xc, float yc, float r) {
-    std::vector<Point> points;
-    float x = 0, y = r, p = 1 - r;
-    while (x <= y) {
-        points.insert(points.end(), {
-            {xc + x, yc + y}, {xc - x, yc + y}, {xc + x, yc - y}, {xc - x, yc - y},
-            {xc + y, yc + x}, {xc - y, yc + x}, {xc + y, yc - x}, {xc - y, yc - x}
-            });
-        x++;
-        if (p < 0)
-        {
-            p += 2 * x + 1;
-        }
-        else
-        {
-            y--, p += 2 * (x - y) + 1;
-        }
+const char* coverageFragmentShaderSource = R"glsl(
+    #version 330 core
+    in float coverage;
+    out vec4 FragColor;
+    uniform vec3 color;
+    void main() {
+        FragColor = vec4(color, coverage);
     }
-    return points;
-}
+)glsl";
 
-std::vector<Point> MidpointEllipse(float xc, float yc, float rx, float ry) {
-    std::vector<Point> points;
-    float rx2 = rx * rx, ry2 = ry * ry;
-    float x = 0, y = ry, p = ry2 - rx2 * ry + 0.25f * rx2;
-
-    // Region 1
-    while (2 * ry2 * x < 2 * rx2 * y) {
-        points.insert(points.end(), {
-            {xc + x, yc + y}, {xc - x, yc + y}, {xc + x, yc - y}, {xc - x, yc - y}
-            });
-        x++;
-        if (p < 0) 
-        {
-            p += 2 * ry2 * x + ry2;
-        }
-        else 
-        {
-            y--, p += 2 * ry2 * x - 2 * rx2 * y + ry2;
-        }
+// draw both lines with Wu's antialiasing instead of DDA/Bresenham
+const bool ANTIALIAS_LINES = false;
+
+
+const char* fragmentShaderSource = R"glsl(
+    #version 330 core
+    out vec4 FragColor;
+    uniform vec3 color;
+    void main() {
+        FragColor = vec4(color, 1.0);
     }
+)glsl";
 
-    // Region 2
-    p = ry2 * (x + 0.5f) * (x + 0.5f) + rx2 * (y - 1) * (y - 1) - rx2 * ry2;
-    while (y >= 0) {
-        points.insert(points.end(), {
-            {xc + x, yc + y}, {xc - x, yc + y}, {xc + x, yc - y}, {xc - x, yc - y}
-            });
-        y--;
-        if (p > 0)
-        {
-            p += -2 * rx2 * y + rx2;
-        }
-        else
-        {
-            x++, p += 2 * ry2 * x - 2 * rx2 * y + rx2;
-        }
+// retained geometry: the color is attribute 1, an array per point or a constant per draw
+const char* storeVertexShaderSource = R"glsl(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in vec4 aColor;
+    out vec4 pointColor;
+
+    void main() {
+        gl_Position = vec4((aPos - 500.0) / 500.0, 0.0, 1.0);
+        pointColor = aColor;
     }
-    return points;
-}
+)glsl";
 
+const char* storeFragmentShaderSource = R"glsl(
+    #version 330 core
+    in vec4 pointColor;
+    out vec4 FragColor;
+    void main() {
+        FragColor = pointColor;
+    }
+)glsl";
 
 void drawPoints(const std::vector<Point>& points, unsigned int shader, float r, float g, float b, GLenum mode = GL_POINTS) {
     if (points.empty())
@@ -178,6 +166,96 @@ void drawPoints(const std::vector<Point>& points, unsigned int shader, float r,
 }
 
 
+// blends every point over what is already drawn, by its coverage
+void drawPoints(const std::vector<CoveragePoint>& points, unsigned int shader, float r, float g, float b) {
+    if (points.empty())
+    {
+        return;
+    }
+
+    unsigned int VAO, VBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(CoveragePoint), points.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(CoveragePoint), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(CoveragePoint), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(shader);
+    glUniform3f(glGetUniformLocation(shader, "color"), r, g, b);
+    glPointSize(1.0f);
+    glDrawArrays(GL_POINTS, 0, points.size());
+
+    glDisable(GL_BLEND);
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+}
+
+
+// draws a procedural circle or ellipse, the shader makes every point from
+// gl_VertexID so the VAO has no buffers or attributes at all
+void drawProcedural(const ProceduralShape& shape, unsigned int shader, float r, float g, float b) {
+    if (shape.count == 0)
+    {
+        return;
+    }
+
+    unsigned int VAO;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+
+    setProceduralUniforms(shader, shape);
+    glUniform3f(glGetUniformLocation(shader, "color"), r, g, b);
+    glPointSize(2.0f);
+    glDrawArrays(GL_POINTS, 0, shape.count);
+
+    glDeleteVertexArrays(1, &VAO);
+}
+
+
+GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vertexSource, NULL);
+    glCompileShader(vertexShader);
+
+    int success;
+    char infoLog[512];
+    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+        std::cerr << "Vertex shader compilation failed:\n" << infoLog << std::endl;
+    }
+
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
+    glCompileShader(fragmentShader);
+
+    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+        std::cerr << "Fragment shader compilation failed:\n" << infoLog << std::endl;
+    }
+
+    GLuint shaderProgram = glCreateProgram();
+    glAttachShader(shaderProgram, vertexShader);
+    glAttachShader(shaderProgram, fragmentShader);
+
+    glLinkProgram(shaderProgram);
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return shaderProgram;
+}
+
+
 //a function to take user input
 void GetInput(float& x1d, float& y1d, float& x2d, float& y2d,
     float& x1b, float& y1b, float& x2b, float& y2b,
@@ -199,7 +277,7 @@ void GetInput(float& x1d, float& y1d, float& x2d, float& y2d,
 
 
 
-int main() {
+int main(int argc, char** argv) {
 
     // initializing glfw
     if (!glfwInit())
@@ -231,68 +309,188 @@ int main() {
 
     glViewport(0, 0, WIDTH, HEIGHT);
 
-    //create the shader program
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cerr << "Vertex shader compilation failed:\n" << infoLog << std::endl;
+    //create the shader programs
+    GLuint shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+    GLuint spanShaderProgram = createShaderProgram(spanVertexShaderSource, storeFragmentShaderSource);
+    GLuint coverageShaderProgram = createShaderProgram(coverageVertexShaderSource, coverageFragmentShaderSource);
+    GLuint proceduralShaderProgram = createShaderProgram(proceduralVertexShaderSource, fragmentShaderSource);
+    GLuint storeShaderProgram = createShaderProgram(storeVertexShaderSource, storeFragmentShaderSource);
+
+    // Everything drawn as plain points never changes, so it is generated once
+    // by the job system straight into one GL buffer and drawn each frame
+    // with a single call. The axes are Bresenham lines, like the headless target.
+    JobSystem jobs;
+    GeometryStore store;
+    std::vector<Point> axes = createCoordinateAxes();
+    for (size_t i = 0; i < axes.size(); i += 2) {
+        store.add({ PrimitiveType::BresenhamLine, axes[i].x, axes[i].y, axes[i + 1].x, axes[i + 1].y }, 1.0f, 1.0f, 1.0f);
     }
 
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cerr << "Fragment shader compilation failed:\n" << infoLog << std::endl;
+    // dashed grid lines, the axes already run through the middle. Every
+    // dash is one span, kept in its own store so it is uploaded once and
+    // drawn under everything else.
+    std::vector<Span> grid;
+    if (GRID_LINES)
+    {
+        SpanBuilder dashes(grid);
+        for (int x = 100; x < WIDTH; x += 100) {
+            if (x == WIDTH / 2) continue;
+            PatternedBresenham((float)x, 0, (float)x, (float)HEIGHT, DASHED_LINE, dashes);
+        }
+        for (int y = 100; y < HEIGHT; y += 100) {
+            if (y == HEIGHT / 2) continue;
+            PatternedBresenham(0, (float)y, (float)WIDTH, (float)y, DASHED_LINE, dashes);
+        }
+        dashes.finish();
     }
+    SpanStore gridStore;
+    gridStore.add(grid, 0.35f, 0.35f, 0.35f);   // grey grid under the scene
+    gridStore.upload();
 
-    
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
+    std::vector<Span> ddaSpans, bresSpans, filledCircle, filledEllipse;
+    std::vector<CoveragePoint> ddaSmooth, bresSmooth;
+    ProceduralShape proceduralCircle = {}, proceduralEllipse = {};
+    Primitive streamedCircle = {}, streamedEllipse = {};
+    bool streamed = false;
 
-    glLinkProgram(shaderProgram);
+    if (argc > 1)
+    {
+        // a primitive file (see primitiveFile.h) replaces the prompts, all of
+        // it is drawn as points in the colors of the prompted scene
+        PrimitiveFile file;
+        if (!file.open(argv[1]))
+        {
+            std::cout << argv[1] << ": " << file.error() << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        std::cout << "loaded " << file.size() << " primitives at " << file.megabytesPerSecond() << " MB/s" << std::endl;
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+        const float colors[4][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 0.0f } };
+        for (size_t i = 0; i < file.size(); i++) {
+            const float* color = colors[(int)file.data()[i].type];
+            store.add(file.data()[i], color[0], color[1], color[2]);
+        }
+    }
+    else
+    {
+        // get user input
+        float x1d, y1d, x2d, y2d, x1b, x2b, y1b, y2b; // line coordinates
+        float xc, yc, r; // circle parameters
+        float xe, ye, rx, ry; // ellipse parameters
 
-    // get user input
-    float x1d, y1d, x2d, y2d, x1b, x2b, y1b, y2b; // line coordinates
-    float xc, yc, r; // circle parameters
-    float xe, ye, rx, ry; // ellipse parameters
+        GetInput(x1d, y1d, x2d, y2d, x1b, y1b, x2b, y2b, xc, yc, r, xe, ye, rx, ry);
 
-    GetInput(x1d, y1d, x2d, y2d, x1b, y1b, x2b, y2b, xc, yc, r, xe, ye, rx, ry);
+        // span versions of the lines, only kept where the runs are smaller
+        // than the points, the other lines go to the store as points. Like
+        // the store, everything below only generates what is in the window.
+        if (USE_SPANS && !ANTIALIAS_LINES)
+        {
+            ddaSpans = DDASpans(x1d+500, y1d+500, x2d+500, y2d+500, SCREEN_VIEWPORT);
+            bresSpans = BresenhamSpans(x1b+500, y1b+500, x2b+500, y2b+500, SCREEN_VIEWPORT);
+            if (!SpansSmaller(ddaSpans, DDACount(x1d+500, y1d+500, x2d+500, y2d+500, SCREEN_VIEWPORT))) ddaSpans.clear();
+            if (!SpansSmaller(bresSpans, BresenhamCount(x1b+500, y1b+500, x2b+500, y2b+500, SCREEN_VIEWPORT))) bresSpans.clear();
+        }
+        if (ANTIALIAS_LINES)
+        {
+            ddaSmooth = WuLine(x1d+500, y1d+500, x2d+500, y2d+500, SCREEN_VIEWPORT);
+            bresSmooth = WuLine(x1b+500, y1b+500, x2b+500, y2b+500, SCREEN_VIEWPORT);
+        }
 
-    // using the line functions
-    auto ddaLine = DDA(x1d+500, y1d+500, x2d+500, y2d+500);
-    auto bresLine = Bresenham(x1b+500, y1b+500, x2b+500, y2b+500);
-    auto circle = MidpointCircle(xc+500, yc+500, r);
-    auto ellipse = MidpointEllipse(xe+500, ye+500, rx, ry);
+        if (!ANTIALIAS_LINES && ddaSpans.empty())
+        {
+            store.add({ PrimitiveType::DDALine, x1d+500, y1d+500, x2d+500, y2d+500 }, 1.0f, 0.0f, 0.0f);      // red DDA
+        }
+        if (!ANTIALIAS_LINES && bresSpans.empty())
+        {
+            store.add({ PrimitiveType::BresenhamLine, x1b+500, y1b+500, x2b+500, y2b+500 }, 0.0f, 1.0f, 0.0f); // green bresenham
+        }
+        if (!FILL_SHAPES && !PROCEDURAL_SHAPES && !STREAM_SHAPES)
+        {
+            store.add({ PrimitiveType::Circle, xc+500, yc+500, r, 0 }, 0.0f, 0.0f, 1.0f);   // blue circle
+            store.add({ PrimitiveType::Ellipse, xe+500, ye+500, rx, ry }, 1.0f, 1.0f, 0.0f); // yellow ellipse
+        }
+
+        // only the form the frame draws is generated
+        if (FILL_SHAPES)
+        {
+            filledCircle = FilledCircle(xc+500, yc+500, r, SCREEN_VIEWPORT);
+            filledEllipse = FilledEllipse(xe+500, ye+500, rx, ry, SCREEN_VIEWPORT);
+        }
+        else if (PROCEDURAL_SHAPES)
+        {
+            proceduralCircle = ProceduralCircle(xc+500, yc+500, r, SCREEN_VIEWPORT);
+            proceduralEllipse = ProceduralEllipse(xe+500, ye+500, rx, ry, SCREEN_VIEWPORT);
+        }
+        streamedCircle = { PrimitiveType::Circle, xc+500, yc+500, r, 0 };
+        streamedEllipse = { PrimitiveType::Ellipse, xe+500, ye+500, rx, ry };
+        streamed = STREAM_SHAPES;
+    }
+    store.packPoints(PACK_POINTS);
+    store.mortonOrder(MORTON_ORDER);
+    store.upload(jobs);
+
+    // the span lines and filled shapes only change with the input, so they
+    // are uploaded once too and drawn after the points, lines first
+    SpanStore spans;
+    spans.add(ddaSpans, 1.0f, 0.0f, 0.0f);        // red DDA
+    spans.add(bresSpans, 0.0f, 1.0f, 0.0f);       // green bresenham
+    spans.add(filledCircle, 0.0f, 0.0f, 1.0f);    // blue disc
+    spans.add(filledEllipse, 1.0f, 1.0f, 0.0f);   // yellow filled ellipse
+    spans.upload();
+    UploadRing ring;
 
     // our main loop
+    typedef std::chrono::steady_clock Clock;
+    Clock::duration frameTime{};
+    size_t frames = 0;
     while (!glfwWindowShouldClose(window)) {
+        Clock::time_point frameStart = Clock::now();
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        drawPoints(createCoordinateAxes(), shaderProgram, 1.0f,1.0f,1.0f,GL_LINES);
+        gridStore.draw(spanShaderProgram);
+        store.draw(storeShaderProgram, 2.0f);
 
-        drawPoints(ddaLine, shaderProgram,1.0f,0.0f,0.0f); // red DDA
-        drawPoints(bresLine, shaderProgram,0.0f,1.0f,0.0f); // green bresenham
-        drawPoints(circle, shaderProgram,0.0f,0.0f,1.0f);   // blue circle
-        drawPoints(ellipse, shaderProgram,1.0f, 1.0f, 0.0f);  // yellow ellipse
+        if (ANTIALIAS_LINES)
+        {
+            drawPoints(ddaSmooth, coverageShaderProgram, 1.0f, 0.0f, 0.0f); // red DDA
+            drawPoints(bresSmooth, coverageShaderProgram, 0.0f, 1.0f, 0.0f); // green bresenham
+        }
+        spans.draw(spanShaderProgram);
+        if (FILL_SHAPES)
+        {
+            // the filled shapes are already in the span store
+        }
+        else if (PROCEDURAL_SHAPES)
+        {
+            drawProcedural(proceduralCircle, proceduralShaderProgram, 0.0f, 0.0f, 1.0f);   // blue circle
+            drawProcedural(proceduralEllipse, proceduralShaderProgram, 1.0f, 1.0f, 0.0f);  // yellow ellipse
+        }
+        else if (streamed)
+        {
+            PointGenerator circle = StreamMidpointCircle(streamedCircle.x1, streamedCircle.y1, streamedCircle.x2);
+            PointGenerator ellipse = StreamMidpointEllipse(streamedEllipse.x1, streamedEllipse.y1, streamedEllipse.x2, streamedEllipse.y2);
+            ring.draw(circle, shaderProgram, 0.0f, 0.0f, 1.0f, 2.0f);   // blue circle
+            ring.draw(ellipse, shaderProgram, 1.0f, 1.0f, 0.0f, 2.0f);  // yellow ellipse
+        }
+        frameTime += Clock::now() - frameStart;
+        frames++;
 
         glfwSwapBuffers(window);
         glfwPollEvents();   
     }
 
+    // time spent issuing draw calls, not waiting for the GPU or vsync
+    if (frames > 0)
+    {
+        std::cout << "CPU frame time: " << std::chrono::duration<double, std::micro>(frameTime).count() / frames << " us over " << frames << " frames" << std::endl;
+    }
+
+    store.release();
+    spans.release();
+    gridStore.release();
+    ring.release();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
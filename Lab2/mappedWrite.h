@@ -0,0 +1,32 @@
+#ifndef MAPPED_WRITE_H
+#define MAPPED_WRITE_H
+
+#include <glad/glad.h>
+#include <vector>
+
+// Fills bytes of the buffer bound to target from offset on by calling
+// write(dst) with where to write them. That is the mapped range as long as
+// the driver maps it. When glMapBufferRange() fails, or glUnmapBuffer()
+// reports the contents lost, write() runs again into memory of our own and
+// that goes up with glBufferSubData(), so write() must produce the same
+// bytes every time it is called.
+template <typename Write>
+void WriteMapped(GLenum target, GLintptr offset, GLsizeiptr bytes, GLbitfield access, Write write) {
+    if (bytes <= 0)
+    {
+        return;
+    }
+    if (void* mapped = glMapBufferRange(target, offset, bytes, access))
+    {
+        write((char*)mapped);
+        if (glUnmapBuffer(target))
+        {
+            return;
+        }
+    }
+    std::vector<char> copy((size_t)bytes);
+    write(copy.data());
+    glBufferSubData(target, offset, bytes, copy.data());
+}
+
+#endif
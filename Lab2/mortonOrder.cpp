@@ -0,0 +1,89 @@
+#include "mortonOrder.h"
+#include <algorithm>
+
+using namespace std;
+
+
+static const int DIGIT_BITS = 8;
+static const int DIGITS = (32 + DIGIT_BITS - 1) / DIGIT_BITS;
+static const size_t BUCKETS = size_t(1) << DIGIT_BITS;
+
+// sorts points into out, which may be points itself. Otherwise the last
+// pass writes straight to out and nothing else touches it.
+template <typename P>
+static void RadixSort(P* points, size_t n, std::vector<P>& scratch, P* out) {
+    if (n < 2)
+    {
+        if (n == 1 && out != points) *out = *points;
+        return;
+    }
+    scratch.resize(std::max(scratch.size(), n));
+
+    // one read for the histograms of every digit. The key is cheap next to
+    // the scattered write, so every pass works it out again instead of
+    // moving a key array along with the points.
+    std::vector<size_t> counts(DIGITS * BUCKETS);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t key = MortonKey(points[i]);
+        for (int d = 0; d < DIGITS; d++) {
+            counts[d * BUCKETS + (key >> (d * DIGIT_BITS) & (BUCKETS - 1))]++;
+        }
+    }
+
+    // digits every point shares need no pass
+    uint32_t firstKey = MortonKey(points[0]);
+    int lastPass = -1;
+    for (int d = 0; d < DIGITS; d++) {
+        if (counts[d * BUCKETS + (firstKey >> (d * DIGIT_BITS) & (BUCKETS - 1))] != n) lastPass = d;
+    }
+
+    P* from = points;
+    P* to = scratch.data();
+    for (int d = 0; d <= lastPass; d++) {
+        int shift = d * DIGIT_BITS;
+        size_t* count = &counts[d * BUCKETS];
+        if (count[firstKey >> shift & (BUCKETS - 1)] == n)
+        {
+            continue;
+        }
+        if (d == lastPass && out != points)
+        {
+            to = out;
+        }
+        size_t offset = 0;
+        for (size_t b = 0; b < BUCKETS; b++) {
+            size_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; i++) {
+            to[count[MortonKey(from[i]) >> shift & (BUCKETS - 1)]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+    if (from != out)
+    {
+        std::copy(from, from + n, out);
+    }
+}
+
+void MortonSort(Point* points, size_t n, std::vector<Point>& scratch) {
+    RadixSort(points, n, scratch, points);
+}
+
+void MortonSort(PackedPoint* points, size_t n, std::vector<PackedPoint>& scratch) {
+    RadixSort(points, n, scratch, points);
+}
+
+void MortonSort(std::vector<Point>& points) {
+    std::vector<Point> scratch;
+    RadixSort(points.data(), points.size(), scratch, points.data());
+}
+
+void MortonSort(Point* points, size_t n, std::vector<Point>& scratch, Point* out) {
+    RadixSort(points, n, scratch, out);
+}
+
+void MortonSort(PackedPoint* points, size_t n, std::vector<PackedPoint>& scratch, PackedPoint* out) {
+    RadixSort(points, n, scratch, out);
+}
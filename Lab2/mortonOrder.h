@@ -0,0 +1,48 @@
+#ifndef MORTON_ORDER_H
+#define MORTON_ORDER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "primitives.h"
+
+// The circle and ellipse generators hand out their points octant by
+// octant, up to eight runs far apart on the framebuffer interleaved point
+// by point, and a batch of primitives jumps around even more. Sorting the
+// points by Morton (Z-order) key puts points that are close on screen
+// close in the buffer, so consecutive writes stay in the same cache lines
+// for a CPU plotter and in the same tiles for the GPU. Points of one color
+// can be drawn in any order, so any generator's output can go through this.
+
+// the 16 bits of v on the even bits
+inline uint32_t SpreadBits(uint32_t v) {
+    v &= 0xFFFF;
+    v = (v | v << 8) & 0x00FF00FFu;
+    v = (v | v << 4) & 0x0F0F0F0Fu;
+    v = (v | v << 2) & 0x33333333u;
+    v = (v | v << 1) & 0x55555555u;
+    return v;
+}
+
+// x on the even bits, y on the odd ones. Flipping the sign bit keeps
+// negative coordinates in order.
+inline uint32_t MortonKey(int16_t x, int16_t y) {
+    return SpreadBits((uint16_t)x ^ 0x8000u) | SpreadBits((uint16_t)y ^ 0x8000u) << 1;
+}
+inline uint32_t MortonKey(const PackedPoint& p) { return MortonKey(p.x, p.y); }
+// the pixel a Point is drawn at, rounded like PackCoordinate
+inline uint32_t MortonKey(const Point& p) { return MortonKey(PackCoordinate(p.x), PackCoordinate(p.y)); }
+
+// LSD radix sort by Morton key, a byte a pass. A pass whose digit is the
+// same for every point is skipped, so points inside the window take three.
+// The sort is stable and leaves the result in points, scratch is grown to
+// n and can be reused between calls.
+void MortonSort(Point* points, size_t n, std::vector<Point>& scratch);
+void MortonSort(PackedPoint* points, size_t n, std::vector<PackedPoint>& scratch);
+void MortonSort(std::vector<Point>& points);
+// the same order written to out, which is only written and only once per
+// point, for mapped buffers. points is overwritten along the way.
+void MortonSort(Point* points, size_t n, std::vector<Point>& scratch, Point* out);
+void MortonSort(PackedPoint* points, size_t n, std::vector<PackedPoint>& scratch, PackedPoint* out);
+
+#endif
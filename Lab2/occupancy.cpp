@@ -0,0 +1,85 @@
+#include "occupancy.h"
+#include <bitset>
+#include <cmath>
+
+using namespace std;
+
+
+OccupancyLayers::OccupancyLayers(const Viewport& view)
+    : view(view), x0((int)std::floor(view.xMin)), y0((int)std::floor(view.yMin)) {
+    w = (int)std::floor(view.xMax) - x0 + 1;
+    h = (int)std::floor(view.yMax) - y0 + 1;
+}
+
+void OccupancyLayers::add(const Primitive& primitive, float r, float g, float b) {
+    uint32_t color = PackColor(r, g, b);
+    auto found = layerOf.find(color);
+    if (found == layerOf.end())
+    {
+        found = layerOf.emplace(color, layer.size()).first;
+        layer.push_back({ color, {}, BitMask(w, h) });
+    }
+    layer[found->second].primitives.push_back(primitive);
+}
+
+void OccupancyLayers::rasterize(JobSystem& jobs) {
+    // points up to half a pixel outside the view round onto its edge
+    Viewport clip = { view.xMin - 0.5f, view.yMin - 0.5f, view.xMax + 0.5f, view.yMax + 0.5f };
+    jobs.parallelFor(layer.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            Layer& l = layer[i];
+            l.mask.clear();
+            OccupancySink sink{ l.mask, x0, y0 };
+            for (const Primitive& p : l.primitives) {
+                GenerateClipped(p, clip, sink);
+            }
+            l.emitted = sink.emitted;
+            l.unique = l.mask.count();
+        }
+    });
+}
+
+size_t OccupancyLayers::bytes() const {
+    size_t n = 0;
+    for (const Layer& l : layer) {
+        n += l.mask.wordsPerRow() * l.mask.height() * sizeof(uint64_t);
+    }
+    return n;
+}
+
+size_t OccupancyLayers::compact(size_t i, PackedPoint* out, JobSystem& jobs) const {
+    const BitMask& mask = layer[i].mask;
+    // the padding bits past the width are always set, the last word of a
+    // row only keeps the pixels below the width
+    size_t full = (size_t)w / 64;
+    uint64_t tail = (uint64_t(1) << (w & 63)) - 1;
+
+    // pixels of every row, then a scan gives where each row starts
+    std::vector<size_t> offsets(h + 1);
+    jobs.parallelFor(h, 64, [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; y++) {
+            const uint64_t* row = mask.row((int)y);
+            size_t n = 0;
+            for (size_t k = 0; k < full; k++) n += std::bitset<64>(row[k]).count();
+            n += std::bitset<64>(row[full] & tail).count();
+            offsets[y] = n;
+        }
+    });
+    size_t total = ParallelExclusiveScan(offsets.data(), offsets.data(), h, jobs);
+
+    jobs.parallelFor(h, 64, [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; y++) {
+            const uint64_t* row = mask.row((int)y);
+            PackedPoint* p = out + offsets[y];
+            int16_t py = (int16_t)(y0 + (int)y);
+            for (size_t k = 0; k <= full; k++) {
+                uint64_t word = k < full ? row[k] : row[k] & tail;
+                while (word) {
+                    *p++ = { (int16_t)(x0 + (int)(k * 64) + LowestBit(word)), py };
+                    word &= word - 1;
+                }
+            }
+        }
+    });
+    return total;
+}
@@ -0,0 +1,74 @@
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include "primitiveBatch.h"
+#include "regionFill.h"
+
+// Thousands of overlapping primitives put the same pixel into many point
+// lists, and every copy is uploaded and rasterized again. Here the
+// generators set bits in a mask instead, one mask per color, so a pixel
+// costs one bit however many primitives cover it. A layer of the
+// 1000 x 1000 window is 128 KB whatever the number of primitives, and only
+// its set pixels are written out for the upload.
+
+// sets the bit of the pixel a point rounds to (as PackCoordinate rounds),
+// bit (0, 0) being pixel (x0, y0). Points off the mask are dropped.
+struct OccupancySink {
+    BitMask& mask;
+    int x0, y0;
+    size_t emitted = 0;
+
+    void put(float x, float y) {
+        int ix = PackCoordinate(x) - x0, iy = PackCoordinate(y) - y0;
+        emitted++;
+        if (ix >= 0 && iy >= 0 && ix < mask.width() && iy < mask.height())
+        {
+            mask.set(ix, iy);
+        }
+    }
+};
+
+class OccupancyLayers {
+public:
+    // covers the pixels of view, whose corners are whole pixels
+    explicit OccupancyLayers(const Viewport& view = SCREEN_VIEWPORT);
+
+    // queues a primitive on the layer of its color, layers keep the order
+    // their colors first appeared in
+    void add(const Primitive& primitive, float r, float g, float b);
+
+    // clears the masks and sets the pixels of every queued primitive. Each
+    // layer is rasterized by one worker, so no mask is shared between threads.
+    void rasterize(JobSystem& jobs);
+
+    size_t layers() const { return layer.size(); }
+    // RGBA8 of a layer, R in the lowest byte
+    uint32_t color(size_t i) const { return layer[i].color; }
+    // pixels set in a layer, and the points its primitives generated
+    size_t unique(size_t i) const { return layer[i].unique; }
+    size_t emitted(size_t i) const { return layer[i].emitted; }
+    // memory of all the masks
+    size_t bytes() const;
+
+    // writes the set pixels of a layer row by row and returns how many
+    size_t compact(size_t i, PackedPoint* out, JobSystem& jobs) const;
+
+private:
+    struct Layer {
+        uint32_t color;
+        std::vector<Primitive> primitives;
+        BitMask mask;
+        size_t emitted = 0, unique = 0;
+    };
+
+    Viewport view;
+    int x0, y0, w, h;
+    std::vector<Layer> layer;
+    std::unordered_map<uint32_t, size_t> layerOf;
+};
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef PIXEL_TYPES_H
+#define PIXEL_TYPES_H
+
+// The two plain types every rasterizer here trades in, on their own so code
+// outside Lab2 (2D Transformation's polygon fill) can use them without the
+// window size, SIMD and job system that come with primitives.h.
+
+// 2D point structure datatype
+struct Point { float x, y; };
+
+// horizontal or vertical run of pixels from (x1, y1) to (x2, y2), both ends included
+struct Span { float x1, y1, x2, y2; };
+
+#endif
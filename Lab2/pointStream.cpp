@@ -0,0 +1,106 @@
+#include "pointStream.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+
+// The loops are those of the sink versions in primitives.h, with every
+// sink.put() turned into a co_yield.
+
+PointGenerator StreamDDA(float x1, float y1, float x2, float y2) {
+    float dx = x2 - x1, dy = y2 - y1;
+    float steps = std::max(std::abs(dx), std::abs(dy));
+    float xInc = dx / steps, yInc = dy / steps;
+    float x = x1, y = y1;
+
+    for (int i = 0; i <= steps; i++) {
+        co_yield Point{ std::round(x), std::round(y) };
+        x += xInc; y += yInc;
+    }
+}
+
+PointGenerator StreamBresenham(float x1, float y1, float x2, float y2) {
+    float dx = std::abs(x2 - x1), dy = std::abs(y2 - y1);
+    bool steep = dy > dx;
+    if (steep)
+    {
+        std::swap(x1, y1), std::swap(x2, y2), std::swap(dx, dy);
+    }
+    if (x1 > x2)
+    {
+        std::swap(x1, x2), std::swap(y1, y2);
+    }
+
+    float y = y1, p = 2 * dy - dx;
+    for (float x = x1; x <= x2; x++) {
+        co_yield steep ? Point{ y, x } : Point{ x, y };
+        if (p >= 0) y += (y2 > y1 ? 1 : -1), p -= 2 * dx;
+        p += 2 * dy;
+    }
+}
+
+PointGenerator StreamMidpointCircle(float xc, float yc, float r) {
+    float x = 0, y = r, p = 1 - r;
+    while (x <= y) {
+        co_yield Point{ xc + x, yc + y };
+        co_yield Point{ xc - x, yc + y };
+        co_yield Point{ xc + x, yc - y };
+        co_yield Point{ xc - x, yc - y };
+        co_yield Point{ xc + y, yc + x };
+        co_yield Point{ xc - y, yc + x };
+        co_yield Point{ xc + y, yc - x };
+        co_yield Point{ xc - y, yc - x };
+        x++;
+        if (p < 0)
+        {
+            p += 2 * x + 1;
+        }
+        else
+        {
+            y--, p += 2 * (x - y) + 1;
+        }
+    }
+}
+
+PointGenerator StreamMidpointEllipse(float xc, float yc, float rx, float ry) {
+    double rx2 = (double)rx * rx, ry2 = (double)ry * ry;
+    double x = 0, y = ry, p = ry2 - rx2 * ry + 0.25 * rx2;
+
+    // Region 1
+    while (2 * ry2 * x < 2 * rx2 * y) {
+        float fx = (float)x, fy = (float)y;
+        co_yield Point{ xc + fx, yc + fy };
+        co_yield Point{ xc - fx, yc + fy };
+        co_yield Point{ xc + fx, yc - fy };
+        co_yield Point{ xc - fx, yc - fy };
+        x++;
+        if (p < 0)
+        {
+            p += 2 * ry2 * x + ry2;
+        }
+        else
+        {
+            y--, p += 2 * ry2 * x - 2 * rx2 * y + ry2;
+        }
+    }
+
+    // Region 2
+    p = ry2 * (x + 0.5) * (x + 0.5) + rx2 * (y - 1) * (y - 1) - rx2 * ry2;
+    while (y >= 0) {
+        float fx = (float)x, fy = (float)y;
+        co_yield Point{ xc + fx, yc + fy };
+        co_yield Point{ xc - fx, yc + fy };
+        co_yield Point{ xc + fx, yc - fy };
+        co_yield Point{ xc - fx, yc - fy };
+        y--;
+        if (p > 0)
+        {
+            p += -2 * rx2 * y + rx2;
+        }
+        else
+        {
+            x++, p += 2 * ry2 * x - 2 * rx2 * y + rx2;
+        }
+    }
+}
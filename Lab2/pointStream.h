@@ -0,0 +1,99 @@
+#ifndef POINT_STREAM_H
+#define POINT_STREAM_H
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <cstddef>
+#include "primitives.h"
+
+// Lazy versions of the generators: a coroutine yields one point at a time
+// and only runs when the consumer asks for the next one, so nothing is
+// stored however many points a primitive has. The consumer below fills a
+// fixed chunk and hands it on whenever it is full, which keeps memory at
+// the chunk size even for an ellipse with a radius of a million pixels.
+// Needs C++20.
+
+// values yielded by a coroutine, pulled one by one with next()
+template <typename T>
+class Generator {
+public:
+    struct promise_type {
+        T current;
+
+        Generator get_return_object() { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        // nothing runs before the first next()
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(const T& value) noexcept {
+            current = value;
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() { throw; }
+    };
+
+    Generator(Generator&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Generator& operator=(Generator&& other) noexcept {
+        std::swap(handle, other.handle);
+        return *this;
+    }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator() {
+        if (handle) handle.destroy();
+    }
+
+    // runs the coroutine to its next value, false once it has finished
+    bool next(T& value) {
+        if (!handle || handle.done())
+        {
+            return false;
+        }
+        handle.resume();
+        if (handle.done())
+        {
+            return false;
+        }
+        value = handle.promise().current;
+        return true;
+    }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+typedef Generator<Point> PointGenerator;
+
+// the same points in the same order as DDA(), Bresenham(), MidpointCircle()
+// and MidpointEllipse() with float math
+PointGenerator StreamDDA(float x1, float y1, float x2, float y2);
+PointGenerator StreamBresenham(float x1, float y1, float x2, float y2);
+PointGenerator StreamMidpointCircle(float xc, float yc, float r);
+PointGenerator StreamMidpointEllipse(float xc, float yc, float rx, float ry);
+
+// bytes of the chunk the stream consumers upload from
+const size_t UPLOAD_RING_BYTES = 1 << 20;
+
+// Pulls points into chunk and calls flush(chunk, count) every time it is
+// full, and once more for what is left at the end. Returns the points streamed.
+template <typename Flush>
+size_t StreamChunks(PointGenerator& points, Point* chunk, size_t capacity, Flush flush) {
+    size_t total = 0, n = 0;
+    while (points.next(chunk[n])) {
+        if (++n == capacity)
+        {
+            flush((const Point*)chunk, n);
+            total += n, n = 0;
+        }
+    }
+    if (n > 0)
+    {
+        flush((const Point*)chunk, n);
+    }
+    return total + n;
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include "polygonFill.h"
+
+using namespace std;
+
+
+EdgeTable::EdgeTable(const Point* vertices, size_t count) {
+    edges.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        Point a = vertices[i], b = vertices[(i + 1) % count];
+        if (a.y == b.y)
+        {
+            continue;
+        }
+
+        // rows whose centre lies in [lower y, upper y) of the edge
+        double low = std::min(a.y, b.y), high = std::max(a.y, b.y);
+        PolygonEdge e;
+        e.first = (int)std::ceil(low - 0.5);
+        e.last = (int)std::ceil(high - 0.5);
+        if (e.first >= e.last)
+        {
+            continue;
+        }
+        e.slope = (double)(b.x - a.x) / (b.y - a.y);
+        e.x = a.x + e.slope * (e.first + 0.5 - a.y);
+        e.winding = b.y > a.y ? 1 : -1;
+        edges.push_back(e);
+    }
+
+    std::sort(edges.begin(), edges.end(), [](const PolygonEdge& a, const PolygonEdge& b) { return a.first < b.first; });
+    if (!edges.empty())
+    {
+        rowTop = edges.front().first, rowBottom = edges.front().last;
+        for (const PolygonEdge& e : edges) {
+            rowBottom = std::max(rowBottom, e.last);
+        }
+        float left = vertices[0].x, right = vertices[0].x;
+        for (size_t i = 1; i < count; i++) {
+            left = std::min(left, vertices[i].x), right = std::max(right, vertices[i].x);
+        }
+        colLeft = (int)std::ceil(left - 0.5), colRight = (int)std::ceil(right - 0.5);
+    }
+}
+
+std::vector<Span> FillPolygon(const std::vector<Point>& vertices, FillRule rule) {
+    EdgeTable table(vertices.data(), vertices.size());
+    std::vector<Span> spans;
+    struct Collect {
+        std::vector<Span>& out;
+        void put(const Span& s) { out.push_back(s); }
+    } sink{ spans };
+    table.scan(table.top(), table.bottom(), rule, sink);
+    return spans;
+}
@@ -0,0 +1,161 @@
+#ifndef POLYGON_FILL_H
+#define POLYGON_FILL_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include "pixelTypes.h"
+
+// Scanline polygon fill with an edge table and an active edge list. A pixel
+// is inside when its centre (x + 0.5, y + 0.5) is, by the chosen rule, so
+// concave and self-intersecting outlines work the same way. A centre
+// exactly on a left edge is in and on a right edge out, which means two
+// polygons sharing an edge never both draw it. Only Point and Span are
+// needed, so the filler builds without the rest of Lab2.
+
+enum class FillRule { EvenOdd, NonZero };
+
+// non-horizontal edge of the outline, x is where it crosses the centre of row first
+struct PolygonEdge {
+    double x, slope;
+    int first, last;    // rows [first, last) whose centres the edge spans
+    int winding;        // +1 going up, -1 going down
+};
+
+// the edges of the closed outline through all vertices, sorted by first row
+class EdgeTable {
+public:
+    EdgeTable(const Point* vertices, size_t count);
+
+    // rows [top, bottom) are the only ones with anything inside
+    int top() const { return rowTop; }
+    int bottom() const { return rowBottom; }
+    size_t size() const { return edges.size(); }
+
+    // calls sink.put(Span) for the inside runs of rows [rowBegin, rowEnd),
+    // every row left to right. Each row range starts from scratch, so
+    // separate ranges can be scanned by separate threads.
+    template <typename Sink>
+    void scan(int rowBegin, int rowEnd, FillRule rule, Sink& sink) const;
+
+private:
+    std::vector<PolygonEdge> edges;
+    int rowTop = 0, rowBottom = 0;
+    int colLeft = 0, colRight = 0;  // every crossing lands in columns [colLeft, colRight]
+};
+
+// spans of the whole polygon, one or more per row
+std::vector<Span> FillPolygon(const std::vector<Point>& vertices, FillRule rule);
+
+
+// keeps the active list in x order. From one row to the next edges only
+// swap where they cross, so insertion sort is nearly free, but an outline
+// crossing itself everywhere would make it quadratic and falls back to std::sort.
+inline void SortActiveEdges(std::vector<PolygonEdge>& active) {
+    size_t moves = 0, budget = 8 * active.size();
+    for (size_t i = 1; i < active.size(); i++) {
+        PolygonEdge e = active[i];
+        size_t j = i;
+        for (; j > 0 && active[j - 1].x > e.x; j--) {
+            active[j] = active[j - 1];
+        }
+        active[j] = e;
+        moves += i - j;
+        if (moves > budget)
+        {
+            std::sort(active.begin(), active.end(), [](const PolygonEdge& a, const PolygonEdge& b) { return a.x < b.x; });
+            return;
+        }
+    }
+}
+
+template <typename Sink>
+void EdgeTable::scan(int rowBegin, int rowEnd, FillRule rule, Sink& sink) const {
+    rowBegin = std::max(rowBegin, rowTop), rowEnd = std::min(rowEnd, rowBottom);
+    if (rowBegin >= rowEnd)
+    {
+        return;
+    }
+
+    // edges that started at or above the first row and are still running there
+    std::vector<PolygonEdge> active;
+    size_t next = std::upper_bound(edges.begin(), edges.end(), rowBegin,
+        [](int row, const PolygonEdge& e) { return row < e.first; }) - edges.begin();
+    for (size_t i = 0; i < next; i++) {
+        if (edges[i].last > rowBegin)
+        {
+            active.push_back(edges[i]);
+            active.back().x += edges[i].slope * (rowBegin - edges[i].first);
+        }
+    }
+
+    auto inside = [rule](int winding) { return rule == FillRule::EvenOdd ? (winding & 1) != 0 : winding != 0; };
+    auto emit = [&](double left, double right, int y) {
+        if (left <= right)
+        {
+            sink.put(Span{ (float)left, (float)y, (float)right, (float)y });
+        }
+    };
+    // winding change at every column of the polygon's width, for crowded rows
+    std::vector<int> change;
+    int columns = colRight - colLeft;
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        for (; next < edges.size() && edges[next].first == y; next++) {
+            active.push_back(edges[next]);
+        }
+        active.erase(std::remove_if(active.begin(), active.end(), [y](const PolygonEdge& e) { return e.last <= y; }), active.end());
+
+        if (active.size() * 16 < (size_t)columns)
+        {
+            // few edges: sort them and walk the crossings left to right.
+            // A run starts where the count becomes inside and ends where it stops
+            SortActiveEdges(active);
+            int winding = 0;
+            double start = 0;
+            for (const PolygonEdge& e : active) {
+                bool was = inside(winding);
+                winding += rule == FillRule::EvenOdd ? 1 : e.winding;
+                if (!was && inside(winding))
+                {
+                    start = e.x;
+                }
+                else if (was && !inside(winding))
+                {
+                    emit(std::ceil(start - 0.5), std::ceil(e.x - 0.5) - 1, y);
+                }
+            }
+        }
+        else
+        {
+            // many edges: add every crossing to the first column it covers
+            // and sum the row up, which is linear in edges plus columns
+            change.resize(columns + 1);
+            for (const PolygonEdge& e : active) {
+                double column = std::ceil(e.x - 0.5) - colLeft;
+                change[column <= 0 ? 0 : column >= columns ? columns : (size_t)column] += rule == FillRule::EvenOdd ? 1 : e.winding;
+            }
+            int winding = 0, start = 0;
+            for (int c = 0; c <= columns; c++) {
+                bool was = inside(winding);
+                winding += change[c];
+                change[c] = 0;
+                if (!was && inside(winding))
+                {
+                    start = c;
+                }
+                else if (was && !inside(winding))
+                {
+                    emit(colLeft + start, colLeft + c - 1, y);
+                }
+            }
+        }
+
+        for (PolygonEdge& e : active) {
+            e.x += e.slope;
+        }
+    }
+}
+
+#endif
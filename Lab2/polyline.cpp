@@ -0,0 +1,59 @@
+#include "polyline.h"
+
+using namespace std;
+
+
+size_t PolylineCount(const Point* vertices, size_t n) {
+    size_t count = n == 1 ? 1 : 0;
+    for (size_t i = 0; i + 1 < n; i++) {
+        count += PolylineSegmentCount(vertices, i);
+    }
+    return count;
+}
+
+std::vector<Point> Polyline(const std::vector<Point>& vertices) {
+    std::vector<Point> points(PolylineCount(vertices.data(), vertices.size()));
+    BufferSink sink(points.data());
+    Polyline(vertices.data(), vertices.size(), sink);
+    return points;
+}
+
+// segments are a handful of pixels each on a dense track, so both passes
+// take them in large ranges
+static const size_t SEGMENT_GRAIN = 4096;
+
+size_t PolylineOffsets(const Point* vertices, size_t n, std::vector<size_t>& offsets, JobSystem& jobs) {
+    if (n < 2)
+    {
+        // no segments, a lone vertex is one point at offset 0
+        offsets.assign(2, 0);
+        offsets[1] = n;
+        return n;
+    }
+    size_t segments = n - 1;
+    offsets.resize(segments + 1);
+    jobs.parallelFor(segments, SEGMENT_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) offsets[i] = PolylineSegmentCount(vertices, i);
+    });
+    return ParallelExclusiveScan(offsets.data(), offsets.data(), segments, jobs);
+}
+
+void GeneratePolyline(const Point* vertices, size_t n, const size_t* offsets, Point* out, JobSystem& jobs) {
+    if (n < 2)
+    {
+        BufferSink sink(out);
+        Polyline(vertices, n, sink);
+        return;
+    }
+    jobs.parallelFor(n - 1, SEGMENT_GRAIN, [&](size_t begin, size_t end) {
+        BufferSink sink(out + offsets[begin]);
+        for (size_t i = begin; i < end; i++) PolylineSegmentPoints(vertices, i, sink);
+    });
+}
+
+std::vector<Point> Polyline(const std::vector<Point>& vertices, JobSystem& jobs) {
+    std::vector<size_t> offsets;
+    std::vector<Point> points(PolylineOffsets(vertices.data(), vertices.size(), offsets, jobs));
+    GeneratePolyline(vertices.data(), vertices.size(), offsets.data(), points.data(), jobs);
+    return points;
+}
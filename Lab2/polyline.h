@@ -0,0 +1,64 @@
+#ifndef POLYLINE_H
+#define POLYLINE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "primitives.h"
+#include "viewportClip.h"
+#include "jobSystem.h"
+
+// Connected paths (line strips) through a vertex array. Every segment is
+// the integer Bresenham walk between its rounded end points, so two
+// neighbouring segments both reach the pixel of the vertex they share.
+// Only the first segment keeps it: every later one leaves out the step on
+// the vertex it starts from, and the path comes out as one run of points
+// with no joint twice. Pixels where the path crosses itself elsewhere are
+// still repeated.
+
+// the walk of segment i, from vertex i to vertex i + 1
+inline BresenhamClip PolylineSegment(const Point* vertices, size_t i) {
+    return BresenhamWalk((int32_t)std::lround(vertices[i].x), (int32_t)std::lround(vertices[i].y),
+        (int32_t)std::lround(vertices[i + 1].x), (int32_t)std::lround(vertices[i + 1].y));
+}
+
+// points of segment i: all dx + 1 steps for the first one, dx for the
+// rest, which leave out the vertex they start from
+inline size_t PolylineSegmentCount(const Point* vertices, size_t i) {
+    BresenhamClip c = PolylineSegment(vertices, i);
+    return (size_t)c.dx + (i == 0);
+}
+
+// writes segment i in the direction its walk runs, which for a reversed
+// walk is towards vertex i, so the joint is its last step instead of its first
+template <typename Sink>
+void PolylineSegmentPoints(const Point* vertices, size_t i, Sink& sink) {
+    BresenhamClip c = PolylineSegment(vertices, i);
+    int64_t skip = i == 0 ? 0 : 1;
+    c.reversed ? BresenhamRun(c, 0, c.dx - skip, sink) : BresenhamRun(c, skip, c.dx, sink);
+}
+
+size_t PolylineCount(const Point* vertices, size_t n);
+
+// a single vertex is one point, no vertices none
+template <typename Sink>
+void Polyline(const Point* vertices, size_t n, Sink& sink) {
+    if (n == 1)
+    {
+        sink.put(std::round(vertices[0].x), std::round(vertices[0].y));
+    }
+    for (size_t i = 0; i + 1 < n; i++) {
+        PolylineSegmentPoints(vertices, i, sink);
+    }
+}
+
+std::vector<Point> Polyline(const std::vector<Point>& vertices);
+
+// Long paths in parallel: the segments are counted, a scan gives where
+// each one starts, and the segments are written there by the job system,
+// the same points in the same order as Polyline().
+size_t PolylineOffsets(const Point* vertices, size_t n, std::vector<size_t>& offsets, JobSystem& jobs);
+void GeneratePolyline(const Point* vertices, size_t n, const size_t* offsets, Point* out, JobSystem& jobs);
+std::vector<Point> Polyline(const std::vector<Point>& vertices, JobSystem& jobs);
+
+#endif
@@ -0,0 +1,118 @@
+#include "primitiveBatch.h"
+
+using namespace std;
+
+
+size_t PrimitiveCount(const Primitive& p) {
+    switch (p.type) {
+    case PrimitiveType::DDALine: return DDACount(p.x1, p.y1, p.x2, p.y2);
+    case PrimitiveType::BresenhamLine: return BresenhamCount(p.x1, p.y1, p.x2, p.y2);
+    case PrimitiveType::Circle: return MidpointCircleUniqueCount(p.x2);
+    default: return MidpointEllipseUniqueCount(p.x2, p.y2);
+    }
+}
+
+void GeneratePrimitive(const Primitive& p, Point* out) {
+    BufferSink sink(out);
+    switch (p.type) {
+    case PrimitiveType::DDALine: DDA(p.x1, p.y1, p.x2, p.y2, sink); break;
+    case PrimitiveType::BresenhamLine: Bresenham(p.x1, p.y1, p.x2, p.y2, sink); break;
+    case PrimitiveType::Circle: MidpointCircleUnique(p.x1, p.y1, p.x2, sink); break;
+    default: MidpointEllipseUnique(p.x1, p.y1, p.x2, p.y2, sink); break;
+    }
+}
+
+size_t PrimitiveCount(const Primitive& p, const Viewport& view) {
+    switch (p.type) {
+    case PrimitiveType::DDALine: return DDACount(p.x1, p.y1, p.x2, p.y2, view);
+    case PrimitiveType::BresenhamLine: return BresenhamCount(p.x1, p.y1, p.x2, p.y2, view);
+    case PrimitiveType::Circle: return MidpointCircleUniqueCount(p.x1, p.y1, p.x2, view);
+    default: return MidpointEllipseUniqueCount(p.x1, p.y1, p.x2, p.y2, view);
+    }
+}
+
+void GeneratePrimitive(const Primitive& p, const Viewport& view, Point* out) {
+    BufferSink sink(out);
+    GenerateClipped(p, view, sink);
+}
+
+void GeneratePrimitive(const Primitive& p, const Viewport& view, PackedPoint* out) {
+    PackedSink sink(out);
+    GenerateClipped(p, view, sink);
+}
+
+void GeneratePrimitive(const Primitive& p, ShapeCache& shapes, Point* out) {
+    switch (p.type) {
+    case PrimitiveType::Circle: CachedCircle(shapes, p.x1, p.y1, p.x2, out); break;
+    case PrimitiveType::Ellipse: CachedEllipse(shapes, p.x1, p.y1, p.x2, p.y2, out); break;
+    default: GeneratePrimitive(p, out); break;
+    }
+}
+
+// counting is cheap and even, generating varies with the size of each
+// primitive, so it gets small ranges that are easy to steal
+static const size_t COUNT_GRAIN = 4096;
+static const size_t GENERATE_GRAIN = 64;
+
+template <typename Count>
+static size_t Offsets(size_t n, std::vector<size_t>& offsets, JobSystem& jobs, Count count) {
+    offsets.resize(n + 1);
+    jobs.parallelFor(n, COUNT_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) offsets[i] = count(i);
+    });
+    return ParallelExclusiveScan(offsets.data(), offsets.data(), n, jobs);
+}
+
+size_t BatchOffsets(const Primitive* batch, size_t n, std::vector<size_t>& offsets, JobSystem& jobs) {
+    return Offsets(n, offsets, jobs, [&](size_t i) { return PrimitiveCount(batch[i]); });
+}
+
+size_t BatchOffsets(const std::vector<Primitive>& batch, std::vector<size_t>& offsets, JobSystem& jobs) {
+    return BatchOffsets(batch.data(), batch.size(), offsets, jobs);
+}
+
+size_t BatchOffsets(const Primitive* batch, size_t n, const Viewport& view, std::vector<size_t>& offsets, JobSystem& jobs) {
+    return Offsets(n, offsets, jobs, [&](size_t i) { return PrimitiveCount(batch[i], view); });
+}
+
+size_t BatchOffsets(const std::vector<Primitive>& batch, const Viewport& view, std::vector<size_t>& offsets, JobSystem& jobs) {
+    return BatchOffsets(batch.data(), batch.size(), view, offsets, jobs);
+}
+
+void GenerateBatch(const Primitive* batch, size_t n, const size_t* offsets, Point* out, JobSystem& jobs) {
+    jobs.parallelFor(n, GENERATE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) GeneratePrimitive(batch[i], out + offsets[i]);
+    });
+}
+
+void GenerateBatch(const std::vector<Primitive>& batch, const size_t* offsets, Point* out, JobSystem& jobs) {
+    GenerateBatch(batch.data(), batch.size(), offsets, out, jobs);
+}
+
+void GenerateBatch(const Primitive* batch, size_t n, const Viewport& view, const size_t* offsets, Point* out, JobSystem& jobs) {
+    jobs.parallelFor(n, GENERATE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) GeneratePrimitive(batch[i], view, out + offsets[i]);
+    });
+}
+
+void GenerateBatch(const std::vector<Primitive>& batch, const Viewport& view, const size_t* offsets, Point* out, JobSystem& jobs) {
+    GenerateBatch(batch.data(), batch.size(), view, offsets, out, jobs);
+}
+
+void GenerateBatch(const std::vector<Primitive>& batch, const Viewport& view, const size_t* offsets, PackedPoint* out, JobSystem& jobs) {
+    jobs.parallelFor(batch.size(), GENERATE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) GeneratePrimitive(batch[i], view, out + offsets[i]);
+    });
+}
+
+void GenerateBatch(const std::vector<Primitive>& batch, ShapeCache& shapes, const size_t* offsets, Point* out, JobSystem& jobs) {
+    jobs.parallelFor(batch.size(), GENERATE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) GeneratePrimitive(batch[i], shapes, out + offsets[i]);
+    });
+}
+
+std::vector<Point> GenerateBatch(const std::vector<Primitive>& batch, std::vector<size_t>& offsets, JobSystem& jobs) {
+    std::vector<Point> points(BatchOffsets(batch, offsets, jobs));
+    GenerateBatch(batch, offsets.data(), points.data(), jobs);
+    return points;
+}
@@ -0,0 +1,62 @@
+#ifndef PRIMITIVE_BATCH_H
+#define PRIMITIVE_BATCH_H
+
+#include <vector>
+#include <cstddef>
+#include "primitives.h"
+#include "viewportClip.h"
+#include "shapeCache.h"
+#include "jobSystem.h"
+
+// Generates many primitives into one contiguous buffer: a parallel pass
+// counts every primitive, a parallel prefix sum turns the counts into
+// offsets, and a second parallel pass writes each primitive at its offset.
+// The result can be uploaded with a single glBufferData.
+
+enum class PrimitiveType { DDALine, BresenhamLine, Circle, Ellipse };
+
+// Lines go from (x1, y1) to (x2, y2). Circles are centred on (x1, y1) with
+// radius x2, ellipses on (x1, y1) with radii x2 and y2. Circles and ellipses
+// use the Unique generators, so every pixel appears once.
+struct Primitive {
+    PrimitiveType type;
+    float x1, y1, x2, y2;
+};
+
+size_t PrimitiveCount(const Primitive& p);
+void GeneratePrimitive(const Primitive& p, Point* out);
+// only the points inside view, skipping whatever lies outside it unwalked
+size_t PrimitiveCount(const Primitive& p, const Viewport& view);
+void GeneratePrimitive(const Primitive& p, const Viewport& view, Point* out);
+void GeneratePrimitive(const Primitive& p, const Viewport& view, PackedPoint* out);
+// the clipped generator of p writing into any sink
+template <typename Sink>
+void GenerateClipped(const Primitive& p, const Viewport& view, Sink& sink) {
+    switch (p.type) {
+    case PrimitiveType::DDALine: DDA(p.x1, p.y1, p.x2, p.y2, view, sink); break;
+    case PrimitiveType::BresenhamLine: Bresenham(p.x1, p.y1, p.x2, p.y2, view, sink); break;
+    case PrimitiveType::Circle: MidpointCircleUnique(p.x1, p.y1, p.x2, view, sink); break;
+    default: MidpointEllipseUnique(p.x1, p.y1, p.x2, p.y2, view, sink); break;
+    }
+}
+// circles and ellipses are moved copies from the cache, the same points
+void GeneratePrimitive(const Primitive& p, ShapeCache& shapes, Point* out);
+
+// fills offsets[0..n] with where every primitive starts in the output
+// and returns the total number of points
+size_t BatchOffsets(const Primitive* batch, size_t n, std::vector<size_t>& offsets, JobSystem& jobs);
+size_t BatchOffsets(const std::vector<Primitive>& batch, std::vector<size_t>& offsets, JobSystem& jobs);
+size_t BatchOffsets(const Primitive* batch, size_t n, const Viewport& view, std::vector<size_t>& offsets, JobSystem& jobs);
+size_t BatchOffsets(const std::vector<Primitive>& batch, const Viewport& view, std::vector<size_t>& offsets, JobSystem& jobs);
+
+// writes every primitive to out + offsets[i]
+void GenerateBatch(const Primitive* batch, size_t n, const size_t* offsets, Point* out, JobSystem& jobs);
+void GenerateBatch(const std::vector<Primitive>& batch, const size_t* offsets, Point* out, JobSystem& jobs);
+void GenerateBatch(const Primitive* batch, size_t n, const Viewport& view, const size_t* offsets, Point* out, JobSystem& jobs);
+void GenerateBatch(const std::vector<Primitive>& batch, const Viewport& view, const size_t* offsets, Point* out, JobSystem& jobs);
+void GenerateBatch(const std::vector<Primitive>& batch, const Viewport& view, const size_t* offsets, PackedPoint* out, JobSystem& jobs);
+void GenerateBatch(const std::vector<Primitive>& batch, ShapeCache& shapes, const size_t* offsets, Point* out, JobSystem& jobs);
+
+std::vector<Point> GenerateBatch(const std::vector<Primitive>& batch, std::vector<size_t>& offsets, JobSystem& jobs);
+
+#endif
@@ -0,0 +1,265 @@
+#include "primitiveFile.h"
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char MAGIC[8] = { 'L', '2', 'P', 'R', 'I', 'M', 'S', '1' };
+static const size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(uint64_t);
+
+// the binary records are Primitive itself
+static_assert(sizeof(Primitive) == 20, "binary primitive files expect 20 byte records");
+
+
+// MAPPED FILE
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const char* path) {
+    close();
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    LARGE_INTEGER size;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size))
+    {
+        file = nullptr;
+        return false;
+    }
+    length = (size_t)size.QuadPart;
+    if (length == 0)
+    {
+        view = "";
+        return true;
+    }
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    view = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (view && length > 0) UnmapViewOfFile(view);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+    view = nullptr, mapping = nullptr, file = nullptr, length = 0;
+}
+#else
+bool MappedFile::open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+    length = (size_t)info.st_size;
+    if (length == 0)
+    {
+        ::close(fd);
+        view = "";
+        return true;
+    }
+    void* mapped = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        length = 0;
+        return false;
+    }
+    madvise(mapped, length, MADV_SEQUENTIAL);
+    view = (const char*)mapped;
+    return true;
+}
+
+void MappedFile::close() {
+    if (view && length > 0) munmap((void*)view, length);
+    view = nullptr, length = 0;
+}
+#endif
+
+
+// TEXT FORMAT
+
+struct PrimitiveKeyword {
+    const char* name;
+    PrimitiveType type;
+    int values;
+};
+
+static const PrimitiveKeyword KEYWORDS[] = {
+    { "dda", PrimitiveType::DDALine, 4 },
+    { "bresenham", PrimitiveType::BresenhamLine, 4 },
+    { "circle", PrimitiveType::Circle, 3 },
+    { "ellipse", PrimitiveType::Ellipse, 4 },
+};
+
+// a known type and finite coordinates, everything that draws a primitive
+// indexes by its type and walks its coordinates, so nothing else is loaded
+static bool ValidPrimitive(const Primitive& p) {
+    return (unsigned)p.type <= (unsigned)PrimitiveType::Ellipse
+        && isfinite(p.x1) && isfinite(p.y1) && isfinite(p.x2) && isfinite(p.y2);
+}
+
+static const char* SkipBlanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p;
+}
+
+bool ParsePrimitives(const char* text, size_t size, std::vector<Primitive>& out, size_t& errorLine) {
+    const char* p = text, * end = text + size;
+    // lines of pixel coordinates are rarely shorter than 16 bytes
+    out.reserve(out.size() + size / 16);
+    for (size_t line = 1; p < end; line++) {
+        const char* eol = (const char*)memchr(p, '\n', end - p);
+        if (!eol) eol = end;
+
+        p = SkipBlanks(p, eol);
+        if (p < eol && *p != '#')
+        {
+            const char* word = p;
+            while (p < eol && *p != ' ' && *p != '\t') p++;
+            // the keywords all start with a different letter
+            const PrimitiveKeyword* keyword = nullptr;
+            for (const PrimitiveKeyword& k : KEYWORDS) {
+                if (k.name[0] == *word) keyword = &k;
+            }
+            if (keyword && ((size_t)(p - word) != strlen(keyword->name) || memcmp(word, keyword->name, p - word) != 0))
+            {
+                keyword = nullptr;
+            }
+
+            // circles leave y2 at 0, like everywhere else; from_chars reads
+            // inf and nan too, those are errors like any other bad number
+            float values[4] = {};
+            for (int i = 0; keyword && i < keyword->values; i++) {
+                from_chars_result result = from_chars(SkipBlanks(p, eol), eol, values[i]);
+                keyword = result.ec == errc() && isfinite(values[i]) ? keyword : nullptr;
+                p = result.ptr;
+            }
+            p = SkipBlanks(p, eol);
+            if (!keyword || (p < eol && *p != '#'))
+            {
+                errorLine = line;
+                return false;
+            }
+            out.push_back({ keyword->type, values[0], values[1], values[2], values[3] });
+        }
+        p = eol + 1;
+    }
+    return true;
+}
+
+bool SavePrimitivesText(const char* path, const Primitive* primitives, size_t count) {
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    std::vector<char> buffer(1 << 16);
+    size_t used = 0;
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; i++) {
+        const Primitive& p = primitives[i];
+        const PrimitiveKeyword& keyword = KEYWORDS[(int)p.type];
+        if (buffer.size() - used < 128)
+        {
+            ok = fwrite(buffer.data(), 1, used, file) == used;
+            used = 0;
+        }
+        char* c = buffer.data() + used;
+        c += strlen(strcpy(c, keyword.name));
+        const float values[4] = { p.x1, p.y1, p.x2, p.y2 };
+        for (int v = 0; v < keyword.values; v++) {
+            *c++ = ' ';
+            c = to_chars(c, buffer.data() + buffer.size(), values[v]).ptr;
+        }
+        *c++ = '\n';
+        used = c - buffer.data();
+    }
+    ok = ok && fwrite(buffer.data(), 1, used, file) == used;
+    return fclose(file) == 0 && ok;
+}
+
+
+// BINARY FORMAT
+
+bool SavePrimitivesBinary(const char* path, const Primitive* primitives, size_t count) {
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    unsigned char header[HEADER_SIZE];
+    memcpy(header, MAGIC, sizeof(MAGIC));
+    for (int i = 0; i < 8; i++) header[sizeof(MAGIC) + i] = (unsigned char)((uint64_t)count >> (8 * i));
+    bool ok = fwrite(header, 1, HEADER_SIZE, file) == HEADER_SIZE
+        && fwrite(primitives, sizeof(Primitive), count, file) == count;
+    return fclose(file) == 0 && ok;
+}
+
+bool PrimitiveFile::open(const char* path) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    primitives = nullptr, count = 0, loadSeconds = 0;
+    parsed.clear();
+    if (!file.open(path))
+    {
+        message = std::string("cannot open ") + path;
+        return false;
+    }
+
+    const char* data = file.data();
+    if (file.size() >= HEADER_SIZE && memcmp(data, MAGIC, sizeof(MAGIC)) == 0)
+    {
+        uint64_t records = 0;
+        for (int i = 0; i < 8; i++) records |= (uint64_t)(unsigned char)data[sizeof(MAGIC) + i] << (8 * i);
+        if (records != (file.size() - HEADER_SIZE) / sizeof(Primitive) || (file.size() - HEADER_SIZE) % sizeof(Primitive) != 0)
+        {
+            message = "binary primitive count does not match the file size";
+            return false;
+        }
+        // the records are used as they are, so each one is checked before
+        // the mapping is handed out
+        const Primitive* loaded = (const Primitive*)(data + HEADER_SIZE);
+        for (size_t i = 0; i < (size_t)records; i++) {
+            if (!ValidPrimitive(loaded[i]))
+            {
+                message = "binary primitive " + std::to_string(i) + " has an unknown type or a coordinate that is not finite";
+                return false;
+            }
+        }
+        primitives = loaded;
+        count = (size_t)records;
+    }
+    else
+    {
+        size_t errorLine = 0;
+        if (!ParsePrimitives(data, file.size(), parsed, errorLine))
+        {
+            message = "syntax error on line " + std::to_string(errorLine);
+            return false;
+        }
+        primitives = parsed.data(), count = parsed.size();
+    }
+    loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
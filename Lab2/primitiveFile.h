@@ -0,0 +1,84 @@
+#ifndef PRIMITIVE_FILE_H
+#define PRIMITIVE_FILE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "primitiveBatch.h"
+
+// Primitive lists on disk, in window pixels like Primitive itself.
+//
+// Text, one primitive per line, blank lines and '#' comments are skipped:
+//   dda x1 y1 x2 y2
+//   bresenham x1 y1 x2 y2
+//   circle xc yc r
+//   ellipse xc yc rx ry
+//
+// Binary: the 8 bytes "L2PRIMS1", the primitive count as a little endian
+// uint64, then the Primitive records exactly as they are in memory. The file
+// is memory mapped and the records are used in place, nothing is copied.
+//
+// Both formats only load known types with finite coordinates, a file with
+// anything else fails to open.
+
+
+// read only view of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    const char* data() const { return view; }
+    size_t size() const { return length; }
+
+private:
+    const char* view = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+
+// parses the text format and appends to out, on a syntax error it returns
+// false and sets errorLine (1 based)
+bool ParsePrimitives(const char* text, size_t size, std::vector<Primitive>& out, size_t& errorLine);
+
+bool SavePrimitivesText(const char* path, const Primitive* primitives, size_t count);
+bool SavePrimitivesBinary(const char* path, const Primitive* primitives, size_t count);
+
+
+// Opens either format, told apart by the binary magic. Binary files are
+// served straight from the mapping, text files are parsed into memory.
+class PrimitiveFile {
+public:
+    bool open(const char* path);
+
+    const Primitive* data() const { return primitives; }
+    size_t size() const { return count; }
+
+    // why open() failed
+    const std::string& error() const { return message; }
+
+    // file size and the time open() took, mapping and parsing included
+    size_t bytes() const { return file.size(); }
+    double seconds() const { return loadSeconds; }
+    double megabytesPerSecond() const { return loadSeconds > 0 ? bytes() / loadSeconds / 1e6 : 0; }
+
+private:
+    MappedFile file;
+    std::vector<Primitive> parsed;
+    const Primitive* primitives = nullptr;
+    size_t count = 0;
+    double loadSeconds = 0;
+    std::string message;
+};
+
+#endif
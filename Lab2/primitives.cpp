@@ -0,0 +1,429 @@
+#include "primitives.h"
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+
+// Function to draw coordinate axes
+std::vector<Point> createCoordinateAxes() {
+    return {
+        {0, HEIGHT / 2}, {WIDTH, HEIGHT / 2},  // X-axis
+        {WIDTH / 2, 0}, {WIDTH / 2, HEIGHT}     // Y-axis
+    };
+}
+
+// POINT COUNTS
+
+static bool IsWhole(float v) {
+    return std::floor(v) == v;
+}
+
+template <>
+size_t DDACount<LineMath::Float>(float x1, float y1, float x2, float y2) {
+    float steps = std::max(abs(x2 - x1), abs(y2 - y1));
+    // DDA() loops while i <= steps, so a fractional step count is cut off
+    return steps >= 0 ? (size_t)steps + 1 : 0;
+}
+
+template <>
+size_t DDACount<LineMath::Integer>(float x1, float y1, float x2, float y2) {
+    long dx = labs(lround(x2) - lround(x1)), dy = labs(lround(y2) - lround(y1));
+    return (size_t)std::max(dx, dy) + 1;
+}
+
+size_t DDAReferenceCount(float x1, float y1, float x2, float y2) {
+    double steps = std::max(abs((double)x2 - x1), abs((double)y2 - y1));
+    return steps >= 0 ? (size_t)steps + 1 : 0;
+}
+
+template <>
+size_t BresenhamCount<LineMath::Float>(float x1, float y1, float x2, float y2) {
+    if (!IsWhole(x1) || !IsWhole(y1) || !IsWhole(x2) || !IsWhole(y2))
+    {
+        // the float loop counter can drift on fractional end points
+        CountingSink counter;
+        Bresenham<LineMath::Float>(x1, y1, x2, y2, counter);
+        return counter.count;
+    }
+    return (size_t)std::max(abs(x2 - x1), abs(y2 - y1)) + 1;
+}
+
+template <>
+size_t BresenhamCount<LineMath::Integer>(float x1, float y1, float x2, float y2) {
+    return DDACount<LineMath::Integer>(x1, y1, x2, y2);
+}
+
+// The closed forms below only hold for whole radii, anything else is counted
+// by running the generator into a CountingSink. The 64 bit products limit
+// them to radii up to 2^15.
+static bool ClosedFormRadius(float r) {
+    return IsWhole(r) && r >= 0 && r <= 32768;
+}
+
+int64_t CircleOctantLastX(int64_t r) {
+    // the walk goes on while x <= y(x), i.e. while 2x^2 - x < r^2 (always for x = 0)
+    int64_t r2 = r * r;
+    int64_t x = (int64_t)((1 + sqrt(1 + 8.0 * r2)) / 4);
+    while (x > 0 && 2 * x * x - x >= r2) x--;
+    while (2 * (x + 1) * (x + 1) - (x + 1) < r2) x++;
+    return x;
+}
+
+int64_t CircleOctantY(int64_t r, int64_t x) {
+    int64_t limit = r * r - x * x;
+    auto passes = [&](int64_t y) { return y * (y - 1) < limit; };
+    int64_t y = (int64_t)((1 + sqrt(1 + 4.0 * limit)) / 2);
+    while (y > 0 && !passes(y)) y--;
+    while (passes(y + 1)) y++;
+    return y;
+}
+
+size_t MidpointCircleCount(float r) {
+    if (!ClosedFormRadius(r))
+    {
+        CountingSink counter;
+        MidpointCircle(0, 0, r, counter);
+        return counter.count;
+    }
+    return 8 * (size_t)(CircleOctantLastX((int64_t)r) + 1);
+}
+
+size_t MidpointCircleUniqueCount(float fr) {
+    int64_t r = (int64_t)llround(fr);
+    if (r <= 0)
+    {
+        return r == 0 ? 1 : 0;
+    }
+
+    // 8 octants, minus the 4 axis pixels and the 4 diagonal pixels they share
+    int64_t last = CircleOctantLastX(r);
+    bool diagonal = CircleOctantY(r, last) == last;
+    return 8 * (size_t)(last + 1) - 4 - (diagonal ? 4 : 0);
+}
+
+// highest y at column x whose midpoint (x, y - 1/2) is still inside the ellipse,
+// which is where region 1 of MidpointEllipse() puts its pixel
+static int64_t EllipseRegion1Y(int64_t rx, int64_t ry, int64_t x) {
+    int64_t rx2 = rx * rx, ry2 = ry * ry;
+    if (x >= rx)
+    {
+        return -1;
+    }
+    auto inside = [&](int64_t y) { return rx2 * (2 * y - 1) * (2 * y - 1) < 4 * ry2 * (rx2 - x * x); };
+    int64_t y = (int64_t)((1 + 2 * ry * sqrt((double)(rx2 - x * x)) / rx) / 2);
+    while (y > 0 && !inside(y)) y--;
+    while (inside(y + 1)) y++;
+    return inside(y) ? y : -1;
+}
+
+// region 1 runs while ry^2 x < rx^2 y, which only gets harder as x grows,
+// so its length is found with a binary search over the columns.
+// Returns the first column after region 1 and sets yEnd to the row region 2
+// starts on. y only ever drops by one per column, which matters on the last column.
+static int64_t EllipseRegion1End(int64_t rx, int64_t ry, int64_t& yEnd) {
+    auto idealY = [&](int64_t x) { return x == 0 ? ry : EllipseRegion1Y(rx, ry, x); };
+    auto yAt = [&](int64_t x) { return x == 0 ? ry : std::max(idealY(x), idealY(x - 1) - 1); };
+    auto inRegion1 = [&](int64_t x) { return ry * ry * x < rx * rx * yAt(x); };
+
+    int64_t lo = 0, hi = rx;
+    while (lo < hi) {
+        int64_t mid = (lo + hi) / 2;
+        if (inRegion1(mid)) lo = mid + 1; else hi = mid;
+    }
+    yEnd = yAt(lo);
+    return lo;
+}
+
+size_t MidpointEllipseCount(float frx, float fry) {
+    if (!ClosedFormRadius(frx) || !ClosedFormRadius(fry))
+    {
+        CountingSink counter;
+        MidpointEllipse(0, 0, frx, fry, counter);
+        return counter.count;
+    }
+
+    // region 2 then steps y from where region 1 stopped down to 0
+    int64_t yEnd, region1 = EllipseRegion1End((int64_t)frx, (int64_t)fry, yEnd);
+    int64_t region2 = std::max<int64_t>(yEnd + 1, 0);
+    return 4 * (size_t)(region1 + region2);
+}
+
+size_t MidpointEllipseUniqueCount(float rx, float ry) {
+    if (!ClosedFormRadius(rx) || !ClosedFormRadius(ry))
+    {
+        CountingSink counter;
+        MidpointEllipseUnique(0, 0, rx, ry, counter);
+        return counter.count;
+    }
+
+    size_t quadrant = MidpointEllipseCount(rx, ry) / 4;
+    if (rx == 0 || ry == 0)
+    {
+        // a vertical bar through the centre (or the single centre pixel)
+        return 2 * quadrant - 1;
+    }
+    // the quadrant starts on the y axis and ends on the x axis,
+    // each of those pixels is shared by two quadrants
+    return 4 * quadrant - 4;
+}
+
+size_t FilledCircleCount(float fr) {
+    // every row from r down to 0, mirrored except the centre row
+    int64_t r = (int64_t)llround(fr);
+    return r < 0 ? 0 : 2 * (size_t)r + 1;
+}
+
+size_t FilledEllipseCount(float ry) {
+    // the walk visits the rows ry, ry - 1, ... down to the last one >= 0,
+    // and only a whole ry ends on the centre row, which is not mirrored
+    if (!(ry >= 0))
+    {
+        return 0;
+    }
+    size_t rows = (size_t)ry + 1;
+    return 2 * rows - (IsWhole(ry) ? 1 : 0);
+}
+
+
+std::vector<Point> DDAReference(float x1, float y1, float x2, float y2) {
+    std::vector<Point> points(DDAReferenceCount(x1, y1, x2, y2));
+    BufferSink sink(points.data());
+    DDAReference(x1, y1, x2, y2, sink);
+    return points;
+}
+
+std::vector<Point> MidpointCircle(float xc, float yc, float r) {
+    std::vector<Point> points(MidpointCircleCount(r));
+    BufferSink sink(points.data());
+    MidpointCircle(xc, yc, r, sink);
+    return points;
+}
+
+std::vector<Point> MidpointEllipse(float xc, float yc, float rx, float ry) {
+    std::vector<Point> points(MidpointEllipseCount(rx, ry));
+    BufferSink sink(points.data());
+    MidpointEllipse(xc, yc, rx, ry, sink);
+    return points;
+}
+
+std::vector<Point> MidpointCircleUnique(float xc, float yc, float r) {
+    std::vector<Point> points(MidpointCircleUniqueCount(r));
+    BufferSink sink(points.data());
+    MidpointCircleUnique(xc, yc, r, sink);
+    return points;
+}
+
+std::vector<Point> MidpointEllipseUnique(float xc, float yc, float rx, float ry) {
+    std::vector<Point> points(MidpointEllipseUniqueCount(rx, ry));
+    BufferSink sink(points.data());
+    MidpointEllipseUnique(xc, yc, rx, ry, sink);
+    return points;
+}
+
+
+// FILLED SHAPES, ROW PARALLEL
+
+// largest x >= 0 that still passes, or -1, for a test that only fails
+// from some x onwards. guess is a floating point estimate of the answer.
+template <typename Pass>
+static int64_t LastPassing(double guess, Pass pass) {
+    int64_t x = std::max<int64_t>((int64_t)guess, 0);
+    while (x >= 0 && !pass(x)) x--;
+    while (pass(x + 1)) x++;
+    return x;
+}
+
+// splits the rows [0, n) between the workers, in blocks small enough for
+// idle workers to steal some from slow ones
+template <typename Rows>
+static void ParallelRows(int64_t n, JobSystem& jobs, Rows rows) {
+    size_t grain = std::max<size_t>(1024, (size_t)n / (jobs.size() * 8));
+    jobs.parallelFor((size_t)n, grain, [&](size_t first, size_t end) { rows((int64_t)first, (int64_t)end); });
+}
+
+// writes row y of half width w to the slots RowFiller would have used
+static void PutRow(Span* out, int64_t top, int64_t y, int64_t w, float xc, float yc) {
+    float fx = (float)w, fy = (float)y;
+    Span* row = out + 2 * (top - y);
+    row[0] = { xc - fx, yc + fy, xc + fx, yc + fy };
+    if (y != 0) row[1] = { xc - fx, yc - fy, xc + fx, yc - fy };
+}
+
+std::vector<Span> FilledCircle(float xc, float yc, float fr) {
+    std::vector<Span> spans(FilledCircleCount(fr));
+    SpanBufferSink sink(spans.data());
+    FilledCircle(xc, yc, fr, sink);
+    return spans;
+}
+
+std::vector<Span> FilledEllipse(float xc, float yc, float frx, float fry) {
+    std::vector<Span> spans(FilledEllipseCount(fry));
+    SpanBufferSink sink(spans.data());
+    FilledEllipse(xc, yc, frx, fry, sink);
+    return spans;
+}
+
+std::vector<Span> FilledCircle(float xc, float yc, float fr, JobSystem& jobs) {
+    int64_t r = (int64_t)llround(fr);
+    if (jobs.size() <= 1 || r <= 0)
+    {
+        return FilledCircle(xc, yc, fr);
+    }
+    std::vector<Span> spans(FilledCircleCount(fr));
+
+    // rows up to the diagonal end on the mirrored octant at y(row), the rows
+    // above it end on the last column x <= last whose y(x) still reaches them
+    int64_t last = CircleOctantLastX(r), r2 = r * r;
+    ParallelRows(r + 1, jobs, [&](int64_t first, int64_t end) {
+        for (int64_t y = first; y < end; y++) {
+            int64_t w = y <= last ? CircleOctantY(r, y)
+                : std::min(last, LastPassing(sqrt((double)(r2 - y * (y - 1))), [&](int64_t x) { return x * x + y * (y - 1) < r2; }));
+            PutRow(spans.data(), r, y, w, xc, yc);
+        }
+    });
+    return spans;
+}
+
+std::vector<Span> FilledEllipse(float xc, float yc, float frx, float fry, JobSystem& jobs) {
+    if (jobs.size() <= 1 || !ClosedFormRadius(frx) || !ClosedFormRadius(fry))
+    {
+        return FilledEllipse(xc, yc, frx, fry);
+    }
+    std::vector<Span> spans(FilledEllipseCount(fry));
+
+    int64_t rx = (int64_t)frx, ry = (int64_t)fry, rx2 = rx * rx, ry2 = ry * ry;
+    int64_t yEnd, region1 = EllipseRegion1End(rx, ry, yEnd);
+
+    // Region 1 puts every column on its ideal row, so a row above yEnd ends on
+    // the last column whose midpoint (x, y - 1/2) is inside. Region 2 starts at
+    // (region1, yEnd) and below that a row ends where the midpoint (x - 1/2, y)
+    // is last inside, except that the walk only moves one column per row.
+    std::vector<int64_t> width((size_t)ry + 1);
+    ParallelRows(ry + 1, jobs, [&](int64_t first, int64_t end) {
+        for (int64_t y = first; y < end; y++) {
+            double s = rx * sqrt(std::max(0.0, 1 - (double)y * y / ((double)ry2)));
+            if (y > yEnd)
+            {
+                int64_t w = LastPassing(s, [&](int64_t x) { return rx2 * (2 * y - 1) * (2 * y - 1) < 4 * ry2 * (rx2 - x * x); });
+                width[y] = std::min(region1 - 1, w);
+            }
+            else if (y == yEnd)
+            {
+                width[y] = region1;
+            }
+            else
+            {
+                width[y] = LastPassing(s + 0.5, [&](int64_t x) { return ry2 * (2 * x - 1) * (2 * x - 1) <= 4 * rx2 * (ry2 - y * y); });
+            }
+        }
+    });
+
+    // catching up after the lag is a short serial pass over the region 2 rows
+    for (int64_t y = yEnd - 1; y >= 0; y--) {
+        width[y] = std::max(width[y + 1], std::min(width[y], width[y + 1] + 1));
+    }
+
+    ParallelRows(ry + 1, jobs, [&](int64_t first, int64_t end) {
+        for (int64_t y = first; y < end; y++) {
+            PutRow(spans.data(), ry, y, width[y], xc, yc);
+        }
+    });
+    return spans;
+}
+
+
+// ELLIPSE WALK
+
+EllipseWalk MidpointEllipseWalk(int64_t rx, int64_t ry) {
+    EllipseWalk walk;
+    walk.region1 = EllipseRegion1End(rx, ry, walk.yEnd);
+
+    // last column of row y whose midpoint (x - 1/2, y) is inside, never below 0
+    int64_t rx2 = rx * rx, ry2 = ry * ry;
+    auto boundary = [&](int64_t y) {
+        double guess = rx * sqrt(std::max(0.0, 1 - (double)y * y / std::max<double>((double)ry2, 1))) + 0.5;
+        return std::max<int64_t>(0, LastPassing(guess, [&](int64_t x) { return ry2 * (2 * x - 1) * (2 * x - 1) <= 4 * rx2 * (ry2 - y * y); }));
+    };
+
+    // Replay the walk until it has caught up with the boundary on a row where
+    // the ellipse is steeper than 45 degrees. From there on the boundary moves
+    // at most one column per row, which the walk can follow exactly.
+    int64_t x = walk.region1;
+    walk.lagEnd = -1;
+    for (int64_t y = walk.yEnd - 1; y >= 0; y--) {
+        int64_t b = boundary(y);
+        x = std::max(x, std::min(b, x + 1));
+        if (x == b && y * y * (rx2 + ry2) <= ry2 * ry2)
+        {
+            walk.lagEnd = y;
+            break;
+        }
+    }
+    return walk;
+}
+
+
+// SPAN MODE
+
+void SpanBuilder::put(float x, float y) {
+    if (open)
+    {
+        // off-pixel walks add 1 to a fractional float, which is not always
+        // exactly 1 apart, so a step counts as unit when it is nearest to 1
+        float sx = x - current.x2, sy = y - current.y2;
+        bool single = current.x1 == current.x2 && current.y1 == current.y2;
+        bool unitStep = (sx == 0 && abs(abs(sy) - 1) < 0.5f) || (sy == 0 && abs(abs(sx) - 1) < 0.5f);
+        float dirX = (float)((sx > 0) - (sx < 0)), dirY = (float)((sy > 0) - (sy < 0));
+
+        if (unitStep && (single || (dirX == stepX && dirY == stepY)))
+        {
+            current.x2 = x, current.y2 = y;
+            stepX = dirX, stepY = dirY;
+            return;
+        }
+        finish();
+    }
+    current = { x, y, x, y };
+    stepX = stepY = 0;
+    open = true;
+}
+
+void SpanBuilder::finish() {
+    if (!open)
+    {
+        return;
+    }
+    // store runs with x1 <= x2 and y1 <= y2 so the quad corners are simply min/max
+    if (current.x1 > current.x2) std::swap(current.x1, current.x2);
+    if (current.y1 > current.y2) std::swap(current.y1, current.y2);
+    spans.push_back(current);
+    open = false;
+}
+
+// a line has about one run per row or column it crosses, whichever are
+// fewer. Off-pixel ends can round a row further apart than they are, and
+// the float sums of an off-pixel walk can drift across a half pixel, which
+// splits a run once on each axis.
+static size_t SpanBound(float x1, float y1, float x2, float y2) {
+    return (size_t)std::ceil(std::min(abs((double)x2 - x1), abs((double)y2 - y1))) + 3;
+}
+
+std::vector<Span> DDASpans(float x1, float y1, float x2, float y2) {
+    std::vector<Span> spans;
+    spans.reserve(SpanBound(x1, y1, x2, y2));
+    SpanBuilder builder(spans);
+    DDA(x1, y1, x2, y2, builder);
+    builder.finish();
+    return spans;
+}
+
+std::vector<Span> BresenhamSpans(float x1, float y1, float x2, float y2) {
+    std::vector<Span> spans;
+    spans.reserve(SpanBound(x1, y1, x2, y2));
+    SpanBuilder builder(spans);
+    Bresenham(x1, y1, x2, y2, builder);
+    builder.finish();
+    return spans;
+}
@@ -0,0 +1,581 @@
+#ifndef PRIMITIVES_H
+#define PRIMITIVES_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "simd.h"
+#include "jobSystem.h"
+#include "pixelTypes.h"
+
+// window size
+const int WIDTH = 1000;
+const int HEIGHT = 1000;
+
+// a pixel in half the bytes of a Point, for uploads. GL reads the shorts
+// as whole floats, so the shaders taking a vec2 position stay as they are.
+struct PackedPoint { int16_t x, y; };
+
+// nearest pixel, halves away from zero like lround. Anything past the int16
+// range stays past it and offscreen. Within the range adding the half is
+// exact, so truncating rounds without a libm call.
+inline int16_t PackCoordinate(float v) {
+    v = std::min(std::max(v, -32768.0f), 32767.0f);
+    return (int16_t)(int)(v + std::copysign(0.5f, v));
+}
+
+// RGBA8 with R in the lowest byte, the per point color of the stores
+inline uint32_t PackColor(float r, float g, float b) {
+    auto channel = [](float v) { return (uint32_t)(std::min(std::max(v, 0.0f), 1.0f) * 255 + 0.5f); };
+    return channel(r) | channel(g) << 8 | channel(b) << 16 | 0xFF000000u;
+}
+
+
+// OUTPUT SINKS
+// Every generator takes a sink and calls sink.put(x, y) once per pixel, so the
+// same algorithm can fill a vector, a mapped GL buffer or a framebuffer.
+
+// writes into memory sized up front with the *Count functions below
+struct BufferSink {
+    Point* out;
+
+    explicit BufferSink(Point* buffer) : out(buffer) {}
+    void put(float x, float y) { *out++ = { x, y }; }
+};
+
+// BufferSink for PackedPoint buffers, the generators write the shorts directly
+struct PackedSink {
+    PackedPoint* out;
+
+    explicit PackedSink(PackedPoint* buffer) : out(buffer) {}
+    void put(float x, float y) { *out++ = { PackCoordinate(x), PackCoordinate(y) }; }
+};
+
+// only counts, for sizing buffers when there is no closed form
+struct CountingSink {
+    size_t count = 0;
+
+    void put(float, float) { count++; }
+};
+
+// plots straight into a row-major 32 bit framebuffer, dropping offscreen pixels
+struct PlotSink {
+    uint32_t* pixels;
+    int width, height;
+    uint32_t color;
+
+    void put(float x, float y) {
+        int ix = (int)x, iy = (int)y;
+        if (ix >= 0 && iy >= 0 && ix < width && iy < height)
+        {
+            pixels[(size_t)iy * width + ix] = color;
+        }
+    }
+
+    // horizontal spans from the filled shapes, clipped to the framebuffer
+    void put(const Span& s) {
+        int iy = (int)s.y1;
+        int x1 = std::max((int)s.x1, 0), x2 = std::min((int)s.x2, width - 1);
+        if (iy >= 0 && iy < height && x1 <= x2)
+        {
+            FillPixels(pixels + (size_t)iy * width + x1, (size_t)(x2 - x1 + 1), color);
+        }
+    }
+};
+
+// span counterpart of BufferSink for the filled shapes
+struct SpanBufferSink {
+    Span* out;
+
+    explicit SpanBufferSink(Span* buffer) : out(buffer) {}
+    void put(const Span& s) { *out++ = s; }
+};
+
+
+// ALGORITHMS
+
+std::vector<Point> createCoordinateAxes();
+
+// arithmetic used inside the line rasterizers. Integer rounds the end points
+// to whole pixels and then runs Bresenham in int32 and DDA in 16.16 fixed point.
+enum class LineMath { Float, Integer };
+
+// exact number of points each generator emits
+template <LineMath M = LineMath::Float>
+size_t DDACount(float x1, float y1, float x2, float y2);
+template <LineMath M = LineMath::Float>
+size_t BresenhamCount(float x1, float y1, float x2, float y2);
+size_t DDAReferenceCount(float x1, float y1, float x2, float y2);
+size_t MidpointCircleCount(float r);
+size_t MidpointEllipseCount(float rx, float ry);
+size_t MidpointCircleUniqueCount(float r);
+size_t MidpointEllipseUniqueCount(float rx, float ry);
+size_t FilledCircleCount(float r);
+// one span per row, so only the height counts
+size_t FilledEllipseCount(float ry);
+
+template <> size_t DDACount<LineMath::Float>(float x1, float y1, float x2, float y2);
+template <> size_t DDACount<LineMath::Integer>(float x1, float y1, float x2, float y2);
+template <> size_t BresenhamCount<LineMath::Float>(float x1, float y1, float x2, float y2);
+template <> size_t BresenhamCount<LineMath::Integer>(float x1, float y1, float x2, float y2);
+
+// the 16.16 distances keep their integer part in 15 bits plus sign
+inline bool FitsFixed16(long long x1, long long y1, long long x2, long long y2) {
+    const long long limit = 32766;
+    return std::llabs(x2 - x1) <= limit && std::llabs(y2 - y1) <= limit;
+}
+
+
+// DDA without accumulated rounding error: every pixel is computed from the
+// exact position i * d / steps. The integer DDA matches this pixel for pixel.
+template <typename Sink>
+void DDAReference(float x1, float y1, float x2, float y2, Sink& sink) {
+    double dx = x2 - x1, dy = y2 - y1;
+    double steps = std::max(std::abs(dx), std::abs(dy));
+
+    for (int i = 0; i <= steps; i++) {
+        // i * d is exact, so the only rounding left is the division
+        double ox = steps > 0 ? i * dx / steps : 0, oy = steps > 0 ? i * dy / steps : 0;
+        sink.put((float)(x1 + std::round(ox)), (float)(y1 + std::round(oy)));
+    }
+}
+
+template <LineMath M = LineMath::Float, typename Sink>
+void DDA(float x1, float y1, float x2, float y2, Sink& sink) {
+    if (M == LineMath::Float)
+    {
+        float dx = x2 - x1, dy = y2 - y1;
+        float steps = std::max(std::abs(dx), std::abs(dy));
+        float xInc = dx / steps, yInc = dy / steps;
+        float x = x1, y = y1;
+
+        for (int i = 0; i <= steps; i++) {
+            sink.put(std::round(x), std::round(y));
+            x += xInc; y += yInc;
+        }
+        return;
+    }
+
+    long lx1 = std::lround(x1), ly1 = std::lround(y1), lx2 = std::lround(x2), ly2 = std::lround(y2);
+    if (!FitsFixed16(lx1, ly1, lx2, ly2))
+    {
+        DDAReference((float)lx1, (float)ly1, (float)lx2, (float)ly2, sink);
+        return;
+    }
+
+    int32_t xs = (int32_t)lx1, ys = (int32_t)ly1;
+    int32_t dx = (int32_t)(lx2 - lx1), dy = (int32_t)(ly2 - ly1);
+    int32_t sx = dx < 0 ? -1 : 1, sy = dy < 0 ? -1 : 1;
+    dx *= sx, dy *= sy;
+    int32_t steps = std::max(dx, dy);
+    if (steps == 0)
+    {
+        sink.put((float)xs, (float)ys);
+        return;
+    }
+
+    // distance walked so far as 16.16, starting at one half so that >> 16 rounds.
+    // The division remainder is carried separately, which keeps the sum exact
+    // however long the line is.
+    int32_t ax = 0x8000, ay = 0x8000;
+    int32_t xInc = (dx << 16) / steps, xRem = (dx << 16) % steps;
+    int32_t yInc = (dy << 16) / steps, yRem = (dy << 16) % steps;
+    int32_t xErr = 0, yErr = 0;
+
+    for (int32_t i = 0; i <= steps; i++) {
+        sink.put((float)(xs + sx * (ax >> 16)), (float)(ys + sy * (ay >> 16)));
+        ax += xInc, xErr += xRem;
+        if (xErr >= steps) ax++, xErr -= steps;
+        ay += yInc, yErr += yRem;
+        if (yErr >= steps) ay++, yErr -= steps;
+    }
+}
+
+template <LineMath M = LineMath::Float, typename Sink>
+void Bresenham(float x1, float y1, float x2, float y2, Sink& sink) {
+    if (M == LineMath::Float)
+    {
+        float dx = std::abs(x2 - x1), dy = std::abs(y2 - y1);
+        bool steep = dy > dx;
+        if (steep)
+        {
+            std::swap(x1, y1), std::swap(x2, y2), std::swap(dx, dy);
+        }
+        if (x1 > x2)
+        {
+            std::swap(x1, x2), std::swap(y1, y2);
+        }
+
+        float y = y1, p = 2 * dy - dx;
+        for (float x = x1; x <= x2; x++) {
+            steep ? sink.put(y, x) : sink.put(x, y);
+            if (p >= 0) y += (y2 > y1 ? 1 : -1), p -= 2 * dx;
+            p += 2 * dy;
+        }
+        return;
+    }
+
+    int32_t ix1 = (int32_t)std::lround(x1), iy1 = (int32_t)std::lround(y1);
+    int32_t ix2 = (int32_t)std::lround(x2), iy2 = (int32_t)std::lround(y2);
+    int32_t dx = std::abs(ix2 - ix1), dy = std::abs(iy2 - iy1);
+    bool steep = dy > dx;
+    if (steep)
+    {
+        std::swap(ix1, iy1), std::swap(ix2, iy2), std::swap(dx, dy);
+    }
+    if (ix1 > ix2)
+    {
+        std::swap(ix1, ix2), std::swap(iy1, iy2);
+    }
+
+    int32_t y = iy1, yStep = iy2 > iy1 ? 1 : -1, p = 2 * dy - dx;
+    for (int32_t x = ix1; x <= ix2; x++) {
+        steep ? sink.put((float)y, (float)x) : sink.put((float)x, (float)y);
+        if (p >= 0) y += yStep, p -= 2 * dx;
+        p += 2 * dy;
+    }
+}
+
+// The first circle octant is x = 0..last with y(x) the largest y where
+// x^2 + y(y - 1) < r^2, which is exactly what the midpoint decision picks.
+int64_t CircleOctantLastX(int64_t r);
+int64_t CircleOctantY(int64_t r, int64_t x);
+
+// calls visit(x, y) for every step of MidpointCircle(), relative to the
+// centre: x counts up from 0 while y comes down from r, until x passes y
+template <typename Visit>
+void MidpointCircleWalk(float r, Visit visit) {
+    float x = 0, y = r, p = 1 - r;
+    while (x <= y) {
+        visit(x, y);
+        x++;
+        if (p < 0)
+        {
+            p += 2 * x + 1;
+        }
+        else
+        {
+            y--, p += 2 * (x - y) + 1;
+        }
+    }
+}
+
+template <typename Sink>
+void MidpointCircle(float xc, float yc, float r, Sink& sink) {
+    MidpointCircleWalk(r, [&](float x, float y) {
+        sink.put(xc + x, yc + y), sink.put(xc - x, yc + y), sink.put(xc + x, yc - y), sink.put(xc - x, yc - y);
+        sink.put(xc + y, yc + x), sink.put(xc - y, yc + x), sink.put(xc + y, yc - x), sink.put(xc - y, yc - x);
+    });
+}
+
+// calls visit(dx, dy) for one octant of MidpointCircleUnique(), relative to
+// the centre and in its order. Octant k covers the angles 45k..45(k + 1)
+// degrees. Even octants walk away from an axis and odd octants walk back
+// towards the next one. Pixels shared by two octants (on the axes and on
+// the diagonal) are only visited by the first octant that reaches them.
+template <typename Visit>
+void MidpointCircleOctant(int64_t r, int octant, Visit visit) {
+    int64_t last = CircleOctantLastX(r), lastY = CircleOctantY(r, last), r2 = r * r;
+    bool diagonal = lastY == last;
+
+    auto put = [&](int64_t x, int64_t y) {
+        switch (octant) {
+        case 0: visit(y, x); break;
+        case 1: visit(x, y); break;
+        case 2: visit(-x, y); break;
+        case 3: visit(-y, x); break;
+        case 4: visit(-y, -x); break;
+        case 5: visit(-x, -y); break;
+        case 6: visit(x, -y); break;
+        default: visit(y, -x); break;
+        }
+    };
+
+    if (octant % 2 == 0)
+    {
+        // away from the axis: the usual midpoint walk
+        int64_t x = 0, y = r, p = 1 - r;
+        while (x <= last) {
+            if (x > 0 || octant == 0) put(x, y);
+            x++;
+            if (p < 0) p += 2 * x + 1;
+            else y--, p += 2 * (x - y) + 1;
+        }
+        return;
+    }
+
+    // back towards the axis: y grows again whenever y + 1 still passes the test
+    int64_t x = last, y = lastY;
+    while (x >= 0) {
+        bool shared = (x == last && diagonal) || (x == 0 && octant == 7);
+        if (!shared) put(x, y);
+        x--;
+        if (x >= 0 && x * x + (y + 1) * y < r2) y++;
+    }
+}
+
+// Same pixels as MidpointCircle() with the radius rounded to whole pixels,
+// but every pixel is emitted once, in counter-clockwise order from (xc + r, yc).
+template <typename Sink>
+void MidpointCircleUnique(float xc, float yc, float fr, Sink& sink) {
+    int64_t r = (int64_t)std::llround(fr);
+    if (r <= 0)
+    {
+        if (r == 0) sink.put(xc, yc);
+        return;
+    }
+
+    for (int octant = 0; octant < 8; octant++) {
+        MidpointCircleOctant(r, octant, [&](int64_t dx, int64_t dy) { sink.put(xc + (float)dx, yc + (float)dy); });
+    }
+}
+
+// calls visit(x, y) for the first quadrant of MidpointEllipse(), relative to
+// the centre, from (0, ry) to (x, 0)
+template <typename Visit>
+void MidpointEllipseQuadrant(float rx, float ry, Visit visit) {
+    // the decision terms grow like rx^2 * ry^2, which float stops
+    // representing exactly once the radii reach a few dozen pixels
+    double rx2 = (double)rx * rx, ry2 = (double)ry * ry;
+    double x = 0, y = ry, p = ry2 - rx2 * ry + 0.25 * rx2;
+
+    // Region 1
+    while (2 * ry2 * x < 2 * rx2 * y) {
+        visit((float)x, (float)y);
+        x++;
+        if (p < 0)
+        {
+            p += 2 * ry2 * x + ry2;
+        }
+        else
+        {
+            y--, p += 2 * ry2 * x - 2 * rx2 * y + ry2;
+        }
+    }
+
+    // Region 2
+    p = ry2 * (x + 0.5) * (x + 0.5) + rx2 * (y - 1) * (y - 1) - rx2 * ry2;
+    while (y >= 0) {
+        visit((float)x, (float)y);
+        y--;
+        if (p > 0)
+        {
+            p += -2 * rx2 * y + rx2;
+        }
+        else
+        {
+            x++, p += 2 * ry2 * x - 2 * rx2 * y + rx2;
+        }
+    }
+}
+
+template <typename Sink>
+void MidpointEllipse(float xc, float yc, float rx, float ry, Sink& sink) {
+    MidpointEllipseQuadrant(rx, ry, [&](float x, float y) {
+        sink.put(xc + x, yc + y), sink.put(xc - x, yc + y);
+        sink.put(xc + x, yc - y), sink.put(xc - x, yc - y);
+    });
+}
+
+// Where the quadrant walk of MidpointEllipse() changes character, for
+// computing any of its points without walking (whole radii up to 2^15).
+// Region 1 has one point per column x < region1, on the highest row whose
+// midpoint (x, y - 1/2) is inside. Region 2 has one point per row y <= yEnd,
+// starting at column region1. Rows y <= lagEnd end on the last column whose
+// midpoint (x - 1/2, y) is inside; rows between lagEnd and yEnd trail that
+// column, because the walk only moves one column per row.
+struct EllipseWalk { int64_t region1, yEnd, lagEnd; };
+EllipseWalk MidpointEllipseWalk(int64_t rx, int64_t ry);
+
+// calls visit(x, y) for the quadrants of MidpointEllipseUnique() set in
+// quadrants (bit 0 for +x +y, 1 for -x +y, 2 for +x -y, 3 for -x -y),
+// relative to the centre. The quadrant is walked once into a buffer and
+// its mirrored copies are read forwards or backwards so the pixels go round
+// the perimeter: +x +y from the y axis to the x axis, then +x -y, -x -y and
+// -x +y. A pixel on an axis belongs to the first quadrant that reaches it.
+template <typename Visit>
+void MidpointEllipseUniqueWalk(float rx, float ry, int quadrants, Visit visit) {
+    // every pixel of the walk steps x or y, so that bounds the quadrant
+    std::vector<Point> quadrant;
+    quadrant.reserve((size_t)(std::abs(rx) + std::abs(ry)) + 2);
+    MidpointEllipseQuadrant(rx, ry, [&](float x, float y) { quadrant.push_back({ x, y }); });
+
+    const Point* begin = quadrant.data();
+    const Point* end = begin + quadrant.size();
+    if (quadrants & 1)
+    {
+        for (const Point* q = begin; q != end; q++) visit(q->x, q->y);
+    }
+    if (quadrants & 4)
+    {
+        for (const Point* q = end; q != begin;) {
+            q--;
+            if (q->y != 0) visit(q->x, -q->y);
+        }
+    }
+    if (quadrants & 8)
+    {
+        for (const Point* q = begin; q != end; q++) {
+            if (q->x != 0) visit(-q->x, -q->y);
+        }
+    }
+    if (quadrants & 2)
+    {
+        for (const Point* q = end; q != begin;) {
+            q--;
+            if (q->x != 0 && q->y != 0) visit(-q->x, q->y);
+        }
+    }
+}
+
+// Same pixels as MidpointEllipse(), each emitted once and in order round
+// the perimeter from (xc, yc + ry).
+template <typename Sink>
+void MidpointEllipseUnique(float xc, float yc, float rx, float ry, Sink& sink) {
+    MidpointEllipseUniqueWalk(rx, ry, 0xF, [&](float x, float y) { sink.put(xc + x, yc + y); });
+}
+
+
+// FILLED SHAPES
+// One horizontal span per row instead of concentric outlines. The quadrant
+// walks already know where every row ends, so a row is finished as soon as
+// the walk steps down to the next one.
+
+// calls visit(x, y) for the first quadrant of MidpointCircleUnique(), relative
+// to the centre, from (0, r) to (r, 0) with x never decreasing
+template <typename Visit>
+void MidpointCircleQuadrant(int64_t r, Visit visit) {
+    if (r <= 0)
+    {
+        if (r == 0) visit(0.0f, 0.0f);
+        return;
+    }
+
+    int64_t last = CircleOctantLastX(r), lastY = CircleOctantY(r, last), r2 = r * r;
+    int64_t x = 0, y = r, p = 1 - r;
+    while (x <= last) {
+        visit((float)x, (float)y);
+        x++;
+        if (p < 0) p += 2 * x + 1;
+        else y--, p += 2 * (x - y) + 1;
+    }
+
+    // the second octant mirrored about the diagonal, walked back towards the x axis
+    x = last, y = lastY;
+    while (x >= 0) {
+        if (x != last || lastY != last) visit((float)y, (float)x);
+        x--;
+        if (x >= 0 && x * x + (y + 1) * y < r2) y++;
+    }
+}
+
+// collects a quadrant walk into rows. x only grows along the walk, so the
+// last pixel seen on a row is its widest, and the row is mirrored to a span
+// above and below the centre when the walk moves on.
+template <typename Sink>
+class RowFiller {
+public:
+    RowFiller(float xc, float yc, Sink& sink) : xc(xc), yc(yc), sink(sink) {}
+
+    void visit(float x, float y) {
+        if (open && y != rowY) finish();
+        rowX = x, rowY = y, open = true;
+    }
+
+    void finish() {
+        if (!open)
+        {
+            return;
+        }
+        sink.put(Span{ xc - rowX, yc + rowY, xc + rowX, yc + rowY });
+        if (rowY != 0) sink.put(Span{ xc - rowX, yc - rowY, xc + rowX, yc - rowY });
+        open = false;
+    }
+
+private:
+    float xc, yc;
+    Sink& sink;
+    float rowX = 0, rowY = 0;
+    bool open = false;
+};
+
+// Disc covering MidpointCircleUnique() and everything inside it, as horizontal
+// spans from the outermost rows inwards: y = r, -r, r - 1, -(r - 1), ..., 0
+template <typename Sink>
+void FilledCircle(float xc, float yc, float r, Sink& sink) {
+    RowFiller<Sink> rows(xc, yc, sink);
+    MidpointCircleQuadrant(std::llround(r), [&](float x, float y) { rows.visit(x, y); });
+    rows.finish();
+}
+
+// same for MidpointEllipse(), in the same row order
+template <typename Sink>
+void FilledEllipse(float xc, float yc, float rx, float ry, Sink& sink) {
+    RowFiller<Sink> rows(xc, yc, sink);
+    MidpointEllipseQuadrant(rx, ry, [&](float x, float y) { rows.visit(x, y); });
+    rows.finish();
+}
+
+
+// vector versions, sized exactly once from the counts
+template <LineMath M = LineMath::Float>
+std::vector<Point> DDA(float x1, float y1, float x2, float y2) {
+    std::vector<Point> points(DDACount<M>(x1, y1, x2, y2));
+    BufferSink sink(points.data());
+    DDA<M>(x1, y1, x2, y2, sink);
+    return points;
+}
+
+template <LineMath M = LineMath::Float>
+std::vector<Point> Bresenham(float x1, float y1, float x2, float y2) {
+    std::vector<Point> points(BresenhamCount<M>(x1, y1, x2, y2));
+    BufferSink sink(points.data());
+    Bresenham<M>(x1, y1, x2, y2, sink);
+    return points;
+}
+
+std::vector<Point> DDAReference(float x1, float y1, float x2, float y2);
+std::vector<Point> MidpointCircle(float xc, float yc, float r);
+std::vector<Point> MidpointEllipse(float xc, float yc, float rx, float ry);
+std::vector<Point> MidpointCircleUnique(float xc, float yc, float r);
+std::vector<Point> MidpointEllipseUnique(float xc, float yc, float rx, float ry);
+
+// With jobs the rows are computed independently from the closed forms and
+// split between the workers, for radii where a single walk gets long.
+// The spans are identical to the serial walk, in the same order.
+std::vector<Span> FilledCircle(float xc, float yc, float r);
+std::vector<Span> FilledEllipse(float xc, float yc, float rx, float ry);
+std::vector<Span> FilledCircle(float xc, float yc, float r, JobSystem& jobs);
+std::vector<Span> FilledEllipse(float xc, float yc, float rx, float ry, JobSystem& jobs);
+
+
+// merges a stream of pixels into runs, a new span starts whenever
+// the next pixel is not the continuation of the current one
+class SpanBuilder {
+public:
+    explicit SpanBuilder(std::vector<Span>& out) : spans(out) {}
+
+    void put(float x, float y);
+    void finish();
+
+private:
+    std::vector<Span>& spans;
+    Span current{};
+    float stepX = 0, stepY = 0;     // direction of the open run
+    bool open = false;
+};
+
+// span mode: same pixels as DDA/Bresenham, merged into axis aligned runs
+std::vector<Span> DDASpans(float x1, float y1, float x2, float y2);
+std::vector<Span> BresenhamSpans(float x1, float y1, float x2, float y2);
+
+// A span is twice the bytes of a point, so runs only pay off on lines whose
+// runs average more than two pixels. Near-diagonal lines have a run per
+// pixel and are smaller drawn as points.
+inline bool SpansSmaller(const std::vector<Span>& spans, size_t points) {
+    return spans.size() * sizeof(Span) < points * sizeof(Point);
+}
+
+#endif
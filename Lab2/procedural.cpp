@@ -0,0 +1,164 @@
+#include "procedural.h"
+#include <cmath>
+
+using namespace std;
+
+
+const char* proceduralVertexShaderSource = R"glsl(
+    #version 330 core
+    uniform int shape;          // 0 circle, 1 ellipse
+    uniform vec2 centre;
+    uniform ivec2 radii;
+    uniform ivec3 walk;         // MidpointEllipseWalk(): region1, yEnd, lagEnd
+    out vec2 point;
+
+    // GLSL 3.30 has no 64 bit integers, so the ellipse tests multiply
+    // into (high, low) pairs of 32 bit halves
+    uvec2 mul64(uint a, uint b) {
+        uint a0 = a & 0xFFFFu, a1 = a >> 16, b0 = b & 0xFFFFu, b1 = b >> 16;
+        uint p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0;
+        uint mid = (p00 >> 16) + (p01 & 0xFFFFu) + (p10 & 0xFFFFu);
+        return uvec2(a1 * b1 + (p01 >> 16) + (p10 >> 16) + (mid >> 16), (p00 & 0xFFFFu) | (mid << 16));
+    }
+
+    bool less64(uvec2 a, uvec2 b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    }
+
+    // largest y with x^2 + y(y - 1) < r^2, see CircleOctantY()
+    int circleY(int x) {
+        uint limit = uint(radii.x * radii.x - x * x);
+        uint y = uint((1.0 + sqrt(1.0 + 4.0 * float(limit))) / 2.0);
+        while (y > 0u && y * (y - 1u) >= limit) y--;
+        while ((y + 1u) * y < limit) y++;
+        return int(y);
+    }
+
+    // region 1: is the midpoint (x, y - 1/2) inside
+    bool insideBelow(int x, int y) {
+        uint a = uint(radii.x * abs(2 * y - 1)), b = uint(2 * radii.y);
+        return less64(mul64(a, a), mul64(b * b, uint(radii.x * radii.x - x * x)));
+    }
+
+    // region 2: is the midpoint (x - 1/2, y) inside
+    bool insideLeft(int x, int y) {
+        uint a = uint(radii.y * abs(2 * x - 1)), b = uint(2 * radii.x);
+        return !less64(mul64(b * b, uint(radii.y * radii.y - y * y)), mul64(a, a));
+    }
+
+    // last row whose midpoint (x, y - 1/2) is inside, -1 if there is none
+    int idealY(int x) {
+        float rx = float(radii.x), ry = float(radii.y);
+        int y = int(0.5 + ry * sqrt(max(0.0, 1.0 - float(x) * float(x) / (rx * rx))));
+        while (y > 0 && !insideBelow(x, y)) y--;
+        while (insideBelow(x, y + 1)) y++;
+        return insideBelow(x, y) ? y : -1;
+    }
+
+    // region 1 drops at most one row per column, see EllipseRegion1End()
+    int ellipseY(int x) {
+        return x == 0 ? radii.y : max(idealY(x), idealY(x - 1) - 1);
+    }
+
+    int ellipseBoundary(int y) {
+        float rx = float(radii.x), ry = max(float(radii.y), 1.0);
+        int x = int(0.5 + rx * sqrt(max(0.0, 1.0 - float(y) * float(y) / (ry * ry))));
+        while (x > 0 && !insideLeft(x, y)) x--;
+        while (insideLeft(x + 1, y)) x++;
+        return x;
+    }
+
+    int ellipseX(int y) {
+        if (y <= walk.z)
+        {
+            return ellipseBoundary(y);
+        }
+        // the few rows right below region 1 trail the boundary, replay them
+        int x = walk.x;
+        for (int row = walk.y - 1; row >= y; row--) {
+            x = max(x, min(ellipseBoundary(row), x + 1));
+        }
+        return x;
+    }
+
+    void main() {
+        vec2 p;
+        if (shape == 0)
+        {
+            // MidpointCircle() puts 8 points per column, in this order
+            int x = gl_VertexID / 8, y = circleY(x);
+            vec2 q = (gl_VertexID % 8) < 4 ? vec2(x, y) : vec2(y, x);
+            int k = gl_VertexID % 4;
+            p = vec2((k & 1) == 0 ? q.x : -q.x, k < 2 ? q.y : -q.y);
+        }
+        else
+        {
+            // MidpointEllipse() puts 4 points per quadrant point
+            int i = gl_VertexID / 4, x, y;
+            if (i < walk.x)
+            {
+                x = i, y = ellipseY(x);
+            }
+            else
+            {
+                y = walk.y - (i - walk.x), x = ellipseX(y);
+            }
+            int k = gl_VertexID % 4;
+            p = vec2((k & 1) == 0 ? float(x) : -float(x), k < 2 ? float(y) : -float(y));
+        }
+
+        point = centre + p;
+        gl_Position = vec4((point - 500.0) / 500.0, 0.0, 1.0);
+    }
+)glsl";
+
+
+// the shader multiplies radii in 32 bits
+static bool ProceduralRadius(long r) {
+    return r >= 0 && r < 32768;
+}
+
+ProceduralShape ProceduralCircle(float xc, float yc, float r) {
+    ProceduralShape shape = { ProceduralKind::Circle, xc, yc, (int)lround(r), (int)lround(r), {}, 0 };
+    if (ProceduralRadius(lround(r)))
+    {
+        shape.count = MidpointCircleCount((float)shape.rx);
+    }
+    return shape;
+}
+
+ProceduralShape ProceduralEllipse(float xc, float yc, float rx, float ry) {
+    ProceduralShape shape = { ProceduralKind::Ellipse, xc, yc, (int)lround(rx), (int)lround(ry), {}, 0 };
+    if (ProceduralRadius(lround(rx)) && ProceduralRadius(lround(ry)))
+    {
+        shape.walk = MidpointEllipseWalk(shape.rx, shape.ry);
+        shape.count = MidpointEllipseCount((float)shape.rx, (float)shape.ry);
+    }
+    return shape;
+}
+
+ProceduralShape ProceduralCircle(float xc, float yc, float r, const Viewport& view) {
+    ProceduralShape shape = ProceduralCircle(xc, yc, r);
+    if (!CircleOctants(xc, yc, (float)shape.rx, view))
+    {
+        shape.count = 0;
+    }
+    return shape;
+}
+
+ProceduralShape ProceduralEllipse(float xc, float yc, float rx, float ry, const Viewport& view) {
+    ProceduralShape shape = ProceduralEllipse(xc, yc, rx, ry);
+    if (!EllipseQuadrants(xc, yc, (float)shape.rx, (float)shape.ry, view))
+    {
+        shape.count = 0;
+    }
+    return shape;
+}
+
+void setProceduralUniforms(GLuint program, const ProceduralShape& shape) {
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "shape"), shape.kind == ProceduralKind::Circle ? 0 : 1);
+    glUniform2f(glGetUniformLocation(program, "centre"), shape.xc, shape.yc);
+    glUniform2i(glGetUniformLocation(program, "radii"), shape.rx, shape.ry);
+    glUniform3i(glGetUniformLocation(program, "walk"), (GLint)shape.walk.region1, (GLint)shape.walk.yEnd, (GLint)shape.walk.lagEnd);
+}
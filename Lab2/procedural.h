@@ -0,0 +1,40 @@
+#ifndef PROCEDURAL_H
+#define PROCEDURAL_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include "primitives.h"
+#include "viewportClip.h"
+
+// Circles and ellipses computed in the vertex shader: point gl_VertexID of
+// MidpointCircle() or MidpointEllipse() comes straight from the closed forms,
+// so drawing one takes a few uniforms, an empty VAO and no vertex buffer.
+// The points and their order match the CPU generators for whole radii.
+// Radii are rounded and must stay below 32768, otherwise nothing is drawn.
+
+// outputs the point as "point" (for transform feedback) and sets gl_Position
+// the same way as the other Lab2 vertex shaders
+extern const char* proceduralVertexShaderSource;
+
+enum class ProceduralKind { Circle, Ellipse };
+
+struct ProceduralShape {
+    ProceduralKind kind;
+    float xc, yc;
+    int rx, ry;
+    EllipseWalk walk;   // ellipses only
+    size_t count;       // points to draw
+};
+
+ProceduralShape ProceduralCircle(float xc, float yc, float r);
+ProceduralShape ProceduralEllipse(float xc, float yc, float rx, float ry);
+// The same, with nothing to draw when the shape's box misses the view. The
+// octants of a shape interleave along gl_VertexID, so a partly visible one
+// is drawn whole and GL drops the points outside the window.
+ProceduralShape ProceduralCircle(float xc, float yc, float r, const Viewport& view);
+ProceduralShape ProceduralEllipse(float xc, float yc, float rx, float ry, const Viewport& view);
+
+// sets the uniforms of a program built from proceduralVertexShaderSource
+void setProceduralUniforms(GLuint program, const ProceduralShape& shape);
+
+#endif
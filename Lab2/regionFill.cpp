@@ -0,0 +1,179 @@
+#include "regionFill.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <bitset>
+
+using namespace std;
+
+
+// BIT MASK
+
+BitMask::BitMask(int width, int height)
+    : w(width), h(height), words((size_t)width / 64 + 1), bits(words * height) {
+    clear();
+}
+
+void BitMask::setSpan(int y, int x1, int x2) {
+    uint64_t* r = row(y);
+    size_t first = x1 >> 6, last = x2 >> 6;
+    uint64_t head = ~uint64_t(0) << (x1 & 63), tail = ~uint64_t(0) >> (63 - (x2 & 63));
+    if (first == last)
+    {
+        r[first] |= head & tail;
+        return;
+    }
+    r[first] |= head;
+    std::fill(r + first + 1, r + last, ~uint64_t(0));
+    r[last] |= tail;
+}
+
+void BitMask::clear() {
+    std::fill(bits.begin(), bits.end(), uint64_t(0));
+    for (int y = 0; y < h; y++) {
+        uint64_t* r = row(y);
+        r[w >> 6] |= ~uint64_t(0) << (w & 63);
+        std::fill(r + (w >> 6) + 1, r + words, ~uint64_t(0));
+    }
+}
+
+size_t BitMask::count() const {
+    size_t n = 0;
+    for (uint64_t word : bits) {
+        n += std::bitset<64>(word).count();
+    }
+    return n - (size_t)h * (words * 64 - w);
+}
+
+
+// SERIAL FILLS
+
+size_t FloodFill(uint32_t* pixels, int width, int height, int x, int y, uint32_t color) {
+    if (x < 0 || y < 0 || x >= width || y >= height || pixels[(size_t)y * width + x] == color)
+    {
+        return 0;
+    }
+    ColorSurface<false> s{ pixels, width, height, pixels[(size_t)y * width + x], color };
+    NullSpanSink sink;
+    return SeedFill(s, x, y, sink);
+}
+
+size_t BoundaryFill(uint32_t* pixels, int width, int height, int x, int y, uint32_t boundary, uint32_t color) {
+    ColorSurface<true> s{ pixels, width, height, boundary, color };
+    NullSpanSink sink;
+    return SeedFill(s, x, y, sink);
+}
+
+
+// BANDED FILLS
+
+template <typename Surface>
+static size_t BandedFill(Surface& s, int x, int y, JobSystem& jobs) {
+    if (x < 0 || y < 0 || x >= s.width() || y >= s.height() || !s.open(x, y))
+    {
+        return 0;
+    }
+
+    struct Band {
+        std::mutex lock;
+        std::vector<FillSeed> inbox;
+        std::atomic<bool> busy{ false };
+    };
+    int bands = (s.height() + FILL_BAND - 1) / FILL_BAND;
+    std::vector<std::unique_ptr<Band>> band(bands);
+    for (std::unique_ptr<Band>& b : band) b.reset(new Band());
+
+    // seeds posted and not yet filled from, children are posted before
+    // their parent is counted off, so zero means the fill is complete
+    std::atomic<size_t> outstanding{ 0 };
+    std::atomic<size_t> filled{ 0 };
+
+    // workers that find nothing to take sleep until a seed is posted or the
+    // fill is complete. They count themselves before checking, and all the
+    // counters are sequentially consistent, so a poster either sees them
+    // waiting or they see its seed.
+    std::mutex idle;
+    std::condition_variable more;
+    std::atomic<uint64_t> posted{ 0 };
+    std::atomic<unsigned> waiting{ 0 };
+    auto notify = [&] {
+        if (waiting > 0)
+        {
+            std::lock_guard<std::mutex> lock(idle);
+            more.notify_all();
+        }
+    };
+
+    auto post = [&](const FillSeed& seed) {
+        outstanding++;
+        {
+            Band& b = *band[seed.y / FILL_BAND];
+            std::lock_guard<std::mutex> lock(b.lock);
+            b.inbox.push_back(seed);
+        }
+        posted++;
+        notify();
+    };
+    post({ y, x, x, 0 });
+
+    jobs.parallelFor(jobs.size(), 1, [&](size_t worker, size_t) {
+        std::vector<FillSeed> stack;
+        NullSpanSink sink;
+        while (outstanding > 0) {
+            uint64_t seen = posted;
+            bool worked = false;
+            for (int i = 0; i < bands; i++) {
+                int k = (int)((i + worker * bands / jobs.size()) % bands);
+                Band& b = *band[k];
+                {
+                    std::lock_guard<std::mutex> lock(b.lock);
+                    if (b.inbox.empty()) continue;
+                }
+                if (b.busy.exchange(true))
+                {
+                    continue;
+                }
+                for (;;) {
+                    {
+                        std::lock_guard<std::mutex> lock(b.lock);
+                        stack.swap(b.inbox);
+                    }
+                    if (stack.empty()) break;
+                    size_t taken = stack.size();
+                    filled += FillSpans(s, stack, k * FILL_BAND, std::min((k + 1) * FILL_BAND, s.height()), post, sink);
+                    if ((outstanding -= taken) == 0) notify();
+                }
+                b.busy = false;
+                worked = true;
+            }
+            if (!worked)
+            {
+                std::unique_lock<std::mutex> lock(idle);
+                waiting++;
+                more.wait(lock, [&] { return posted != seen || outstanding == 0; });
+                waiting--;
+            }
+        }
+    });
+    return filled;
+}
+
+size_t FloodFill(BitMask& mask, int x, int y, JobSystem& jobs) {
+    MaskSurface s{ mask };
+    return BandedFill(s, x, y, jobs);
+}
+
+size_t FloodFill(uint32_t* pixels, int width, int height, int x, int y, uint32_t color, JobSystem& jobs) {
+    if (x < 0 || y < 0 || x >= width || y >= height || pixels[(size_t)y * width + x] == color)
+    {
+        return 0;
+    }
+    ColorSurface<false> s{ pixels, width, height, pixels[(size_t)y * width + x], color };
+    return BandedFill(s, x, y, jobs);
+}
+
+size_t BoundaryFill(uint32_t* pixels, int width, int height, int x, int y, uint32_t boundary, uint32_t color, JobSystem& jobs) {
+    ColorSurface<true> s{ pixels, width, height, boundary, color };
+    return BandedFill(s, x, y, jobs);
+}
@@ -0,0 +1,262 @@
+#ifndef REGION_FILL_H
+#define REGION_FILL_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "primitives.h"
+#include "jobSystem.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Seed fills: starting from one pixel, fill every pixel 4-connected to it
+// that is still open. Flood fill treats pixels of the seed's colour as open,
+// boundary fill everything except the boundary colour. The outlines of
+// Lab2 (MidpointCircle, MidpointEllipse, Bresenham) are 8-connected, which
+// is exactly what keeps a 4-connected fill from leaking through them.
+//
+// The fill works on runs, never single pixels: it finds the whole open run
+// around a seed on its row, fills it with one call and remembers which rows
+// to look at next as spans on an explicit stack (Heckbert's seed fill). No
+// recursion, and no queue entry per pixel.
+
+
+inline int LowestBit(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward64(&i, v);
+    return (int)i;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+inline int HighestBit(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanReverse64(&i, v);
+    return (int)i;
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+
+// one bit per pixel, rows padded to whole 64 bit words with at least one
+// bit to spare. Set bits are walls or already filled. The padding bits are
+// always set, so a scan along a row stops at the right edge by itself.
+class BitMask {
+public:
+    BitMask(int width, int height);
+
+    int width() const { return w; }
+    int height() const { return h; }
+    size_t wordsPerRow() const { return words; }
+    const uint64_t* row(int y) const { return &bits[(size_t)y * words]; }
+    uint64_t* row(int y) { return &bits[(size_t)y * words]; }
+
+    bool get(int x, int y) const { return row(y)[x >> 6] >> (x & 63) & 1; }
+    void set(int x, int y) { row(y)[x >> 6] |= uint64_t(1) << (x & 63); }
+    // sets x1..x2 of row y, both ends included
+    void setSpan(int y, int x1, int x2);
+
+    // all pixels open again
+    void clear();
+    // set pixels, padding not counted
+    size_t count() const;
+
+private:
+    int w, h;
+    size_t words;
+    std::vector<uint64_t> bits;
+};
+
+// outline generators draw walls into a mask through this, offscreen pixels are dropped
+struct MaskSink {
+    BitMask& mask;
+
+    void put(float x, float y) {
+        int ix = (int)x, iy = (int)y;
+        if (x >= 0 && y >= 0 && ix < mask.width() && iy < mask.height())
+        {
+            mask.set(ix, iy);
+        }
+    }
+};
+
+
+// The fill only needs five questions answered about a surface: is a pixel
+// open, how far does an open run reach left and right, where is the next
+// open pixel on a row, and fill a run. The mask answers them a word at a time.
+struct MaskSurface {
+    BitMask& mask;
+
+    int width() const { return mask.width(); }
+    int height() const { return mask.height(); }
+    bool open(int x, int y) const { return !mask.get(x, y); }
+
+    // first pixel of the open run through x
+    int left(int x, int y) const {
+        const uint64_t* r = mask.row(y);
+        size_t i = x >> 6;
+        uint64_t word = r[i] & ((uint64_t(1) << (x & 63)) - 1);
+        while (!word) {
+            if (i == 0) return 0;
+            word = r[--i];
+        }
+        return (int)(i * 64) + HighestBit(word) + 1;
+    }
+    // last pixel of the open run through x
+    int right(int x, int y) const {
+        const uint64_t* r = mask.row(y);
+        size_t i = x >> 6;
+        uint64_t word = r[i] & (~uint64_t(0) << (x & 63));
+        while (!word) word = r[++i];
+        return (int)(i * 64) + LowestBit(word) - 1;
+    }
+    // first open pixel in [x, end], end + 1 if there is none
+    int nextOpen(int x, int end, int y) const {
+        const uint64_t* r = mask.row(y);
+        size_t i = x >> 6, last = end >> 6;
+        uint64_t word = ~r[i] & (~uint64_t(0) << (x & 63));
+        while (!word) {
+            if (i == last) return end + 1;
+            word = ~r[++i];
+        }
+        return std::min((int)(i * 64) + LowestBit(word), end + 1);
+    }
+    void fill(int y, int x1, int x2) { mask.setSpan(y, x1, x2); }
+};
+
+// row-major RGBA pixels like PlotSink's. Flood fill opens the pixels that
+// match the colour under the seed, boundary fill everything that is
+// neither the boundary nor the fill colour.
+template <bool Boundary>
+struct ColorSurface {
+    uint32_t* pixels;
+    int w, h;
+    uint32_t match, color;  // match is the seed colour, or the boundary colour for boundary fill
+
+    int width() const { return w; }
+    int height() const { return h; }
+    bool open(uint32_t p) const { return Boundary ? p != match && p != color : p == match; }
+    bool open(int x, int y) const { return open(pixels[(size_t)y * w + x]); }
+
+    int left(int x, int y) const {
+        const uint32_t* r = pixels + (size_t)y * w;
+        while (x > 0 && open(r[x - 1])) x--;
+        return x;
+    }
+    int right(int x, int y) const {
+        const uint32_t* r = pixels + (size_t)y * w;
+        while (x + 1 < w && open(r[x + 1])) x++;
+        return x;
+    }
+    int nextOpen(int x, int end, int y) const {
+        const uint32_t* r = pixels + (size_t)y * w;
+        while (x <= end && !open(r[x])) x++;
+        return x;
+    }
+    void fill(int y, int x1, int x2) { FillPixels(pixels + (size_t)y * w + x1, (size_t)(x2 - x1 + 1), color); }
+};
+
+
+// look for open runs on row y within [l, r]. The run [l, r] on row y - dy
+// was filled already; dy == 0 marks the very first seed.
+struct FillSeed { int y, l, r, dy; };
+
+// Fills from the seeds on the stack until it is empty, only ever touching
+// rows [rowBegin, rowEnd). A seed for a row outside that range is handed
+// to leave(seed) instead, which is how the tile version passes work on.
+// Every filled run also goes to sink.put(Span). Returns the pixels filled.
+template <typename Surface, typename Leave, typename Sink>
+size_t FillSpans(Surface& s, std::vector<FillSeed>& stack, int rowBegin, int rowEnd, Leave leave, Sink& sink) {
+    size_t filled = 0;
+    auto push = [&](int y, int l, int r, int dy) {
+        if (y < 0 || y >= s.height())
+        {
+            return;
+        }
+        if (y < rowBegin || y >= rowEnd)
+        {
+            leave(FillSeed{ y, l, r, dy });
+            return;
+        }
+        stack.push_back({ y, l, r, dy });
+    };
+
+    while (!stack.empty()) {
+        FillSeed seed = stack.back();
+        stack.pop_back();
+        int y = seed.y;
+        int x = s.nextOpen(seed.l, seed.r, y);
+        while (x <= seed.r) {
+            // only the first run can reach left of the seed, the pixel before the others is closed
+            int a = x == seed.l ? s.left(x, y) : x, b = s.right(x, y);
+            s.fill(y, a, b);
+            sink.put(Span{ (float)a, (float)y, (float)b, (float)y });
+            filled += b - a + 1;
+
+            if (seed.dy == 0)
+            {
+                push(y + 1, a, b, 1);
+                push(y - 1, a, b, -1);
+            }
+            else
+            {
+                // keep going the same way, and turn back where the run overhangs its parent
+                push(y + seed.dy, a, b, seed.dy);
+                if (a < seed.l) push(y - seed.dy, a, seed.l - 1, -seed.dy);
+                if (b > seed.r) push(y - seed.dy, seed.r + 1, b, -seed.dy);
+            }
+            if (b + 1 > seed.r) break;
+            x = s.nextOpen(b + 1, seed.r, y);
+        }
+    }
+    return filled;
+}
+
+// for fills nobody needs the spans of
+struct NullSpanSink {
+    void put(const Span&) {}
+};
+
+// 4-connected fill of the open pixels around (x, y), returns the pixels filled
+template <typename Surface, typename Sink>
+size_t SeedFill(Surface& s, int x, int y, Sink& sink) {
+    if (x < 0 || y < 0 || x >= s.width() || y >= s.height() || !s.open(x, y))
+    {
+        return 0;
+    }
+    std::vector<FillSeed> stack = { { y, x, x, 0 } };
+    return FillSpans(s, stack, 0, s.height(), [](const FillSeed&) {}, sink);
+}
+
+
+// fills the clear bits around (x, y), every filled run goes to sink.put(Span)
+template <typename Sink>
+size_t FloodFill(BitMask& mask, int x, int y, Sink& sink) {
+    MaskSurface s{ mask };
+    return SeedFill(s, x, y, sink);
+}
+
+// paints the region of (x, y)'s colour around it in color
+size_t FloodFill(uint32_t* pixels, int width, int height, int x, int y, uint32_t color);
+// paints everything around (x, y) up to the boundary colour in color
+size_t BoundaryFill(uint32_t* pixels, int width, int height, int x, int y, uint32_t boundary, uint32_t color);
+
+// The same fills split into bands of FILL_BAND rows. Every band is filled by
+// one worker at a time, which only touches its own rows and posts seeds for
+// the rows of a neighbour into that band's inbox. A band starts as soon as
+// seeds arrive, so the fill spreads over the workers while it runs. The
+// result is the same as the serial fill.
+const int FILL_BAND = 64;
+
+size_t FloodFill(BitMask& mask, int x, int y, JobSystem& jobs);
+size_t FloodFill(uint32_t* pixels, int width, int height, int x, int y, uint32_t color, JobSystem& jobs);
+size_t BoundaryFill(uint32_t* pixels, int width, int height, int x, int y, uint32_t boundary, uint32_t color, JobSystem& jobs);
+
+#endif
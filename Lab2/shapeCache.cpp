@@ -0,0 +1,83 @@
+#include "shapeCache.h"
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+using namespace std;
+
+
+size_t ShapeCache::KeyHash::operator()(const Key& k) const {
+    uint32_t x, y;
+    std::memcpy(&x, &k.rx, sizeof(x));
+    std::memcpy(&y, &k.ry, sizeof(y));
+    return std::hash<uint64_t>()(((uint64_t)x << 32 | y) ^ (k.ellipse ? 0x9E3779B97F4A7C15ull : 0));
+}
+
+template <typename Generate>
+ShapePoints ShapeCache::lookup(const Key& key, Generate generate) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = index.find(key);
+        if (found != index.end())
+        {
+            lru.splice(lru.begin(), lru, found->second);
+            hits++;
+            return found->second->second;
+        }
+        misses++;
+    }
+
+    // two workers missing the same shape both walk it, the second insert is dropped
+    ShapePoints points = std::make_shared<const std::vector<Point>>(generate());
+    size_t size = points->size() * sizeof(Point);
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (index.count(key) || size > maxBytes)
+    {
+        return points;
+    }
+    while (bytes + size > maxBytes) {
+        bytes -= lru.back().second->size() * sizeof(Point);
+        index.erase(lru.back().first);
+        lru.pop_back();
+        evictions++;
+    }
+    lru.emplace_front(key, points);
+    index[key] = lru.begin();
+    bytes += size;
+    return points;
+}
+
+ShapePoints ShapeCache::circle(float r) {
+    float whole = (float)std::llround(r);
+    return lookup(Key{ false, whole, whole }, [&] { return MidpointCircleUnique(0, 0, whole); });
+}
+
+ShapePoints ShapeCache::ellipse(float rx, float ry) {
+    return lookup(Key{ true, rx, ry }, [&] { return MidpointEllipseUnique(0, 0, rx, ry); });
+}
+
+ShapeCache::Stats ShapeCache::stats() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return { hits, misses, evictions, lru.size(), bytes };
+}
+
+void ShapeCache::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    lru.clear();
+    index.clear();
+    bytes = hits = misses = evictions = 0;
+}
+
+
+// moving the origin points by the centre gives exactly xc + dx, the sum
+// the generators compute, so the result is the same to the bit
+void CachedCircle(ShapeCache& cache, float xc, float yc, float r, Point* out) {
+    ShapePoints points = cache.circle(r);
+    TranslatePoints(points->data(), points->size(), xc, yc, out);
+}
+
+void CachedEllipse(ShapeCache& cache, float xc, float yc, float rx, float ry, Point* out) {
+    ShapePoints points = cache.ellipse(rx, ry);
+    TranslatePoints(points->data(), points->size(), xc, yc, out);
+}
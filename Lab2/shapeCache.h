@@ -0,0 +1,89 @@
+#ifndef SHAPE_CACHE_H
+#define SHAPE_CACHE_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include "primitives.h"
+#include "simd.h"
+
+// Circles and ellipses of the same size are the same points moved to a
+// different centre. The cache keeps the points of each size around the
+// origin, so drawing another circle of a known radius is one add per
+// point instead of a midpoint walk. Entries are dropped least recently
+// used first once the cache holds more than its byte budget.
+
+// points of one shape around (0, 0), shared by everyone drawing it. A
+// shape stays valid while someone holds it, even after the cache drops it.
+typedef std::shared_ptr<const std::vector<Point>> ShapePoints;
+
+const size_t SHAPE_CACHE_BYTES = 64 << 20;
+
+class ShapeCache {
+public:
+    explicit ShapeCache(size_t maxBytes = SHAPE_CACHE_BYTES) : maxBytes(maxBytes) {}
+
+    // MidpointCircleUnique(0, 0, r), which only depends on the rounded radius
+    ShapePoints circle(float r);
+    // MidpointEllipseUnique(0, 0, rx, ry)
+    ShapePoints ellipse(float rx, float ry);
+
+    struct Stats {
+        size_t hits, misses, evictions;
+        size_t entries, bytes;      // what is cached right now
+
+        double hitRate() const { return hits + misses ? (double)hits / (hits + misses) : 0; }
+    };
+    Stats stats() const;
+    // drops every shape and zeroes the counters
+    void clear();
+
+private:
+    struct Key {
+        bool ellipse;
+        float rx, ry;
+
+        bool operator==(const Key& o) const { return ellipse == o.ellipse && rx == o.rx && ry == o.ry; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const;
+    };
+    typedef std::list<std::pair<Key, ShapePoints>> LruList;
+
+    template <typename Generate>
+    ShapePoints lookup(const Key& key, Generate generate);
+
+    // lookups come from the batch workers, the walk on a miss runs unlocked
+    mutable std::mutex lock;
+    LruList lru;    // most recently used first
+    std::unordered_map<Key, LruList::iterator, KeyHash> index;
+    size_t maxBytes, bytes = 0;
+    size_t hits = 0, misses = 0, evictions = 0;
+};
+
+// out[i] = in[i] + (dx, dy), Simd::LANES / 2 points at a time
+inline void TranslatePoints(const Point* in, size_t n, float dx, float dy, Point* out) {
+    const float* src = &in[0].x;
+    float* dst = &out[0].x;
+    size_t floats = 2 * n, i = 0;
+#if defined(SIMD_AVX2) || defined(SIMD_SSE2)
+    float pattern[Simd::LANES];
+    for (int l = 0; l < Simd::LANES; l++) pattern[l] = l % 2 ? dy : dx;
+    Simd::V offset = Simd::load(pattern);
+    for (; i + Simd::LANES <= floats; i += Simd::LANES) {
+        Simd::store(dst + i, Simd::add(Simd::load(src + i), offset));
+    }
+#endif
+    for (; i < floats; i++) dst[i] = src[i] + (i % 2 ? dy : dx);
+}
+
+// the same points as MidpointCircleUnique(xc, yc, r, sink) and
+// MidpointEllipseUnique(xc, yc, rx, ry, sink), written to out
+void CachedCircle(ShapeCache& cache, float xc, float yc, float r, Point* out);
+void CachedEllipse(ShapeCache& cache, float xc, float yc, float rx, float ry, Point* out);
+
+#endif
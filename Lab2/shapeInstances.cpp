@@ -0,0 +1,98 @@
+#include "shapeInstances.h"
+
+using namespace std;
+
+
+ShapeInstances::~ShapeInstances() {
+    release();
+}
+
+void ShapeInstances::release() {
+    if (VAO)
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &pointVBO);
+        glDeleteBuffers(1, &instanceVBO);
+        VAO = pointVBO = instanceVBO = 0;
+    }
+}
+
+void ShapeInstances::add(const Primitive& p, float r, float g, float b) {
+    ShapePoints points;
+    if (p.type == PrimitiveType::Circle)
+    {
+        points = cache.circle(p.x2);
+    }
+    else if (p.type == PrimitiveType::Ellipse)
+    {
+        points = cache.ellipse(p.x2, p.y2);
+    }
+    else
+    {
+        return;
+    }
+
+    // the cache hands out the same points for the same shape while it keeps them
+    auto found = groupOf.find(points.get());
+    if (found == groupOf.end())
+    {
+        found = groupOf.emplace(points.get(), groups.size()).first;
+        groups.emplace_back();
+        groups.back().points = points;
+    }
+    groups[found->second].instances.push_back({ p.x1, p.y1, PackColor(r, g, b) });
+    count++;
+}
+
+void ShapeInstances::upload() {
+    std::vector<Point> points;
+    std::vector<Instance> instances;
+    instances.reserve(count);
+    for (Group& g : groups) {
+        g.first = (GLint)points.size();
+        g.firstInstance = instances.size();
+        points.insert(points.end(), g.points->begin(), g.points->end());
+        instances.insert(instances.end(), g.instances.begin(), g.instances.end());
+    }
+    uploaded = points.size();
+
+    if (!VAO)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &pointVBO);
+        glGenBuffers(1, &instanceVBO);
+    }
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, pointVBO);
+    glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(Point), points.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Point), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance), instances.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glBindVertexArray(0);
+}
+
+void ShapeInstances::draw(GLuint shader, float pointSize) const {
+    if (!VAO || groups.empty())
+    {
+        return;
+    }
+    glBindVertexArray(VAO);
+    glUseProgram(shader);
+    glPointSize(pointSize);
+
+    // GL 3.3 has no base instance, so the instance attributes are pointed
+    // at each shape's centres before its draw
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (const Group& g : groups) {
+        size_t at = g.firstInstance * sizeof(Instance);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)at);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance), (void*)(at + 2 * sizeof(float)));
+        glDrawArraysInstanced(GL_POINTS, g.first, (GLsizei)g.points->size(), (GLsizei)g.instances.size());
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef SHAPE_INSTANCES_H
+#define SHAPE_INSTANCES_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include "geometryStore.h"
+#include "shapeCache.h"
+
+// Circles and ellipses drawn from the shape cache on the GPU. The points of
+// every distinct shape are uploaded once, and each primitive of that shape
+// is an instance with its own centre and color, so a thousand circles of
+// one radius upload one circle and a thousand centres.
+class ShapeInstances {
+public:
+    explicit ShapeInstances(ShapeCache& cache) : cache(cache) {}
+    ~ShapeInstances();
+    ShapeInstances(const ShapeInstances&) = delete;
+    ShapeInstances& operator=(const ShapeInstances&) = delete;
+
+    // queues a circle or ellipse, lines are ignored
+    void add(const Primitive& primitive, float r, float g, float b);
+
+    // uploads every shape and all the centres
+    void upload();
+
+    // one instanced draw per shape. The shader takes the point relative to
+    // the centre at location 0, the centre at location 1 and the color at
+    // location 2. Instances of one shape are drawn in the order they were
+    // added, the shapes in the order they first appeared.
+    void draw(GLuint shader, float pointSize) const;
+
+    // deletes the GL objects, needs the context to still be current
+    void release();
+
+    size_t shapes() const { return groups.size(); }
+    size_t instances() const { return count; }
+    // points uploaded, against the sum over every instance when generated one by one
+    size_t points() const { return uploaded; }
+
+private:
+    struct Instance {
+        float x, y;
+        uint32_t color;     // R in the lowest byte
+    };
+    struct Group {
+        ShapePoints points;
+        std::vector<Instance> instances;
+        GLint first = 0;            // of the shape in the point buffer
+        size_t firstInstance = 0;   // in the instance buffer
+    };
+
+    ShapeCache& cache;
+    std::vector<Group> groups;
+    std::unordered_map<const std::vector<Point>*, size_t> groupOf;
+    size_t count = 0, uploaded = 0;
+    GLuint VAO = 0, pointVBO = 0, instanceVBO = 0;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// The vector kernels only need a handful of operations, so each
+// instruction set is wrapped in a small struct and the loops are shared.
+// SIMD_AVX2 or SIMD_SSE2 tells which one (if any) was compiled in.
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_SSE2
+#endif
+
+#if defined(SIMD_AVX2)
+struct Simd {
+    typedef __m256 V;
+    static const int LANES = 8;
+
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V set1(float v) { return _mm256_set1_ps(v); }
+    static V ramp() { return _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static V floor(V v) { return _mm256_floor_ps(v); }
+
+    // std::round() rounds halves away from zero, which none of the
+    // rounding modes do, so truncate and fix up the fraction instead.
+    // Floats from 2^23 up are whole already and may not fit the int32
+    // truncation, so those lanes (and NaNs) are passed through as they are.
+    static V round(V v) {
+        V sign = _mm256_and_ps(v, _mm256_set1_ps(-0.0f));
+        V t = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(v));
+        V half = _mm256_cmp_ps(abs(_mm256_sub_ps(v, t)), _mm256_set1_ps(0.5f), _CMP_GE_OQ);
+        V one = _mm256_or_ps(_mm256_set1_ps(1.0f), sign);
+        V rounded = _mm256_or_ps(_mm256_add_ps(t, _mm256_and_ps(half, one)), sign);
+        return _mm256_blendv_ps(rounded, v, whole(v));
+    }
+
+    // lanes too large to have a fraction, or NaN
+    static V whole(V v) { return _mm256_cmp_ps(abs(v), _mm256_set1_ps(8388608.0f), _CMP_NLT_UQ); }
+};
+#elif defined(SIMD_SSE2)
+struct Simd {
+    typedef __m128 V;
+    static const int LANES = 4;
+
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+    static V set1(float v) { return _mm_set1_ps(v); }
+    static V ramp() { return _mm_setr_ps(0, 1, 2, 3); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+    static V max(V a, V b) { return _mm_max_ps(a, b); }
+    static V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+    // SSE2 has no floor, truncate and step down where that went up
+    static V floor(V v) {
+        V t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+        t = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f)));
+        return select(whole(v), v, t);
+    }
+
+    static V round(V v) {
+        V sign = _mm_and_ps(v, _mm_set1_ps(-0.0f));
+        V t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+        V half = _mm_cmpge_ps(abs(_mm_sub_ps(v, t)), _mm_set1_ps(0.5f));
+        V one = _mm_or_ps(_mm_set1_ps(1.0f), sign);
+        V rounded = _mm_or_ps(_mm_add_ps(t, _mm_and_ps(half, one)), sign);
+        return select(whole(v), v, rounded);
+    }
+
+    // lanes from 2^23 up are whole already and may not fit the int32
+    // truncation above, those (and NaNs) are passed through as they are
+    static V whole(V v) { return _mm_cmpnlt_ps(abs(v), _mm_set1_ps(8388608.0f)); }
+    static V select(V mask, V a, V b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+};
+#endif
+
+// Double lanes for kernels that need exact integer arithmetic beyond what
+// a float holds. Every integer below 2^53 is a double, so sums, products
+// and compares of such integers give the same answer as int64_t would.
+#if defined(SIMD_AVX2)
+struct SimdD {
+    typedef __m256d V;
+    static const int LANES = 4;
+
+    static V load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+    static void storeInt(int* p, V v) { _mm_storeu_si128((__m128i*)p, _mm256_cvtpd_epi32(v)); }
+    static V set1(double v) { return _mm256_set1_pd(v); }
+    static V zero() { return _mm256_setzero_pd(); }
+    static V add(V a, V b) { return _mm256_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    static V less(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static V greater(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static V and_(V a, V b) { return _mm256_and_pd(a, b); }
+    static V or_(V a, V b) { return _mm256_or_pd(a, b); }
+    static V andnot(V a, V b) { return _mm256_andnot_pd(a, b); }
+    static int mask(V v) { return _mm256_movemask_pd(v); }
+};
+#elif defined(SIMD_SSE2)
+struct SimdD {
+    typedef __m128d V;
+    static const int LANES = 2;
+
+    static V load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+    static void storeInt(int* p, V v) { _mm_storel_epi64((__m128i*)p, _mm_cvtpd_epi32(v)); }
+    static V set1(double v) { return _mm_set1_pd(v); }
+    static V zero() { return _mm_setzero_pd(); }
+    static V add(V a, V b) { return _mm_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+    static V less(V a, V b) { return _mm_cmplt_pd(a, b); }
+    static V greater(V a, V b) { return _mm_cmpgt_pd(a, b); }
+    static V and_(V a, V b) { return _mm_and_pd(a, b); }
+    static V or_(V a, V b) { return _mm_or_pd(a, b); }
+    static V andnot(V a, V b) { return _mm_andnot_pd(a, b); }
+    static int mask(V v) { return _mm_movemask_pd(v); }
+};
+#endif
+
+// n copies of value from dst on, the span fill of the software framebuffers
+inline void FillPixels(uint32_t* dst, size_t n, uint32_t value) {
+    size_t i = 0;
+#if defined(SIMD_AVX2)
+    __m256i v = _mm256_set1_epi32((int)value);
+    for (; i + 8 <= n; i += 8) _mm256_storeu_si256((__m256i*)(dst + i), v);
+#elif defined(SIMD_SSE2)
+    __m128i v = _mm_set1_epi32((int)value);
+    for (; i + 4 <= n; i += 4) _mm_storeu_si128((__m128i*)(dst + i), v);
+#endif
+    for (; i < n; i++) dst[i] = value;
+}
+
+// name of the instruction set the kernels were compiled for
+inline const char* SimdISA() {
+#if defined(SIMD_AVX2)
+    return "AVX2";
+#elif defined(SIMD_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+#endif
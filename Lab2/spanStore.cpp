@@ -0,0 +1,65 @@
+#include "spanStore.h"
+
+using namespace std;
+
+
+SpanStore::~SpanStore() {
+    release();
+}
+
+void SpanStore::release() {
+    if (VAO)
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &quadVBO);
+        glDeleteBuffers(1, &VBO);
+        VAO = quadVBO = VBO = 0;
+    }
+}
+
+void SpanStore::add(const std::vector<Span>& list, float r, float g, float b) {
+    spans.insert(spans.end(), list.begin(), list.end());
+    colors.insert(colors.end(), list.size(), PackColor(r, g, b));
+}
+
+void SpanStore::upload() {
+    static const float corners[] = { 0, 0, 1, 0, 0, 1, 1, 1 };
+
+    if (!VAO)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &quadVBO);
+        glGenBuffers(1, &VBO);
+    }
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // one span and one color per instance
+    size_t colorStart = spans.size() * sizeof(Span);
+    uploaded = colorStart + colors.size() * sizeof(uint32_t);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, uploaded, NULL, GL_STATIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, colorStart, spans.data());
+    glBufferSubData(GL_ARRAY_BUFFER, colorStart, uploaded - colorStart, colors.data());
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Span), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(uint32_t), (void*)colorStart);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glBindVertexArray(0);
+    drawn = spans.size();
+}
+
+void SpanStore::draw(GLuint shader) const {
+    if (!VAO || drawn == 0)
+    {
+        return;
+    }
+    glBindVertexArray(VAO);
+    glUseProgram(shader);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)drawn);
+}
@@ -0,0 +1,46 @@
+#ifndef SPAN_STORE_H
+#define SPAN_STORE_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "primitives.h"
+
+// Span lists that never change, kept on the GPU the way GeometryStore keeps
+// points. Every span is an instance of one unit quad, the spans of all lists
+// back to back in one buffer followed by one RGBA8 color per span, so a
+// frame draws them all with a single glDrawArraysInstanced and nothing is
+// created, uploaded or deleted per frame.
+class SpanStore {
+public:
+    SpanStore() = default;
+    ~SpanStore();
+    SpanStore(const SpanStore&) = delete;
+    SpanStore& operator=(const SpanStore&) = delete;
+
+    // queues a list of spans in one color, nothing reaches the GPU before upload()
+    void add(const std::vector<Span>& list, float r, float g, float b);
+
+    // uploads every queued span into a new buffer
+    void upload();
+
+    // draws the spans in the order they were added. The shader takes the
+    // quad corner at location 0, the span at 1 and its color at 2.
+    void draw(GLuint shader) const;
+
+    // deletes the GL objects, needs the context to still be current
+    void release();
+
+    size_t size() const { return spans.size(); }
+    // size of the uploaded buffer, spans and colors
+    size_t bytes() const { return uploaded; }
+
+private:
+    std::vector<Span> spans;
+    std::vector<uint32_t> colors;   // R in the lowest byte
+    size_t drawn = 0, uploaded = 0;
+    GLuint VAO = 0, quadVBO = 0, VBO = 0;
+};
+
+#endif
@@ -0,0 +1,332 @@
+#include "sweep.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <atomic>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <charconv>
+#include "primitives.h"
+#include "primitiveFile.h"
+#include "simd.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+
+// ALLOCATION COUNTING
+
+// every allocation in the bench goes through here, so a case can see how
+// many the generator made. The whole replaceable set is defined, array,
+// aligned and nothrow forms included, so no allocation slips past the count
+// and every delete frees memory the matching new allocated.
+static std::atomic<size_t> allocations{ 0 };
+
+static void* Allocate(size_t size, size_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    size = size ? size : 1;
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        return std::malloc(size);
+    }
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+static void Release(void* p, size_t alignment) noexcept {
+#ifdef _WIN32
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        _aligned_free(p);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(p);
+}
+
+static void* AllocateOrThrow(size_t size, size_t alignment) {
+    if (void* p = Allocate(size, alignment))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+static const size_t PLAIN = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+void* operator new(size_t size) { return AllocateOrThrow(size, PLAIN); }
+void* operator new[](size_t size) { return AllocateOrThrow(size, PLAIN); }
+void* operator new(size_t size, std::align_val_t al) { return AllocateOrThrow(size, (size_t)al); }
+void* operator new[](size_t size, std::align_val_t al) { return AllocateOrThrow(size, (size_t)al); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Allocate(size, PLAIN); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return Allocate(size, PLAIN); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return Allocate(size, (size_t)al); }
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return Allocate(size, (size_t)al); }
+
+void operator delete(void* p) noexcept { Release(p, PLAIN); }
+void operator delete[](void* p) noexcept { Release(p, PLAIN); }
+void operator delete(void* p, size_t) noexcept { Release(p, PLAIN); }
+void operator delete[](void* p, size_t) noexcept { Release(p, PLAIN); }
+void operator delete(void* p, std::align_val_t al) noexcept { Release(p, (size_t)al); }
+void operator delete[](void* p, std::align_val_t al) noexcept { Release(p, (size_t)al); }
+void operator delete(void* p, size_t, std::align_val_t al) noexcept { Release(p, (size_t)al); }
+void operator delete[](void* p, size_t, std::align_val_t al) noexcept { Release(p, (size_t)al); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { Release(p, PLAIN); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { Release(p, PLAIN); }
+void operator delete(void* p, std::align_val_t al, const std::nothrow_t&) noexcept { Release(p, (size_t)al); }
+void operator delete[](void* p, std::align_val_t al, const std::nothrow_t&) noexcept { Release(p, (size_t)al); }
+
+static size_t PeakRSSKilobytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize / 1024 : 0;
+#else
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? (size_t)usage.ru_maxrss : 0;
+#endif
+}
+
+
+// CASES
+
+struct SweepResult {
+    std::string name;
+    size_t pixels;          // per call
+    double nsPerPixel;
+    double pixelsPerSecond;
+    double allocsPerCall;
+    size_t peakRSS;         // KB
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static volatile float keep;
+
+// Calls generate until a run takes at least minSeconds, then keeps the best
+// of three such runs. generate returns the points of one call.
+template <typename Generate>
+static SweepResult Measure(const std::string& name, double minSeconds, Generate generate) {
+    SweepResult result = { name, generate().size(), 0, 0, 0, 0 };
+
+    size_t calls = 1;
+    double best = 0;
+    for (int run = 0; run < 3; run++) {
+        for (;;) {
+            size_t before = allocations.load();
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < calls; i++) {
+                std::vector<Point> points = generate();
+                keep = points.empty() ? 0 : points.back().x;
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if (seconds < minSeconds)
+            {
+                calls *= 2;
+                continue;
+            }
+            double perCall = seconds / calls;
+            if (best == 0 || perCall < best)
+            {
+                best = perCall;
+            }
+            result.allocsPerCall = (double)(allocations.load() - before) / calls;
+            break;
+        }
+    }
+
+    size_t pixels = std::max<size_t>(result.pixels, 1);
+    result.nsPerPixel = best * 1e9 / pixels;
+    result.pixelsPerSecond = pixels / best;
+    result.peakRSS = PeakRSSKilobytes();
+    return result;
+}
+
+static std::vector<SweepResult> Sweep(double minSeconds) {
+    std::vector<SweepResult> results;
+    const float lengths[] = { 8, 64, 512, 4096 };
+    const int angles[] = { 0, 15, 30, 45, 60, 75, 90 };
+    const float radii[] = { 4, 32, 256, 2048, 16384 };
+    const float majors[] = { 32, 256, 2048 };
+    const float ratios[] = { 1.0f, 0.75f, 0.5f, 0.25f, 0.1f };
+
+    for (float length : lengths) {
+        for (int angle : angles) {
+            // whole pixel end points, so both rasterizers walk the same line
+            float x2 = std::round(length * (float)std::cos(angle * 3.14159265 / 180));
+            float y2 = std::round(length * (float)std::sin(angle * 3.14159265 / 180));
+            std::string suffix = "/length=" + std::to_string((int)length) + "/angle=" + std::to_string(angle);
+            results.push_back(Measure("dda" + suffix, minSeconds, [&] { return DDA(0, 0, x2, y2); }));
+            results.push_back(Measure("bresenham" + suffix, minSeconds, [&] { return Bresenham(0, 0, x2, y2); }));
+        }
+    }
+    for (float r : radii) {
+        results.push_back(Measure("circle/r=" + std::to_string((int)r), minSeconds, [&] { return MidpointCircle(0, 0, r); }));
+    }
+    for (float rx : majors) {
+        for (float ratio : ratios) {
+            float ry = std::round(rx * ratio);
+            char name[64];
+            snprintf(name, sizeof(name), "ellipse/rx=%d/ry=%d", (int)rx, (int)ry);
+            results.push_back(Measure(name, minSeconds, [&] { return MidpointEllipse(0, 0, rx, ry); }));
+        }
+    }
+    return results;
+}
+
+
+// JSON
+
+// one case per line, so the baseline can be read back line by line
+static std::string ToJSON(const std::vector<SweepResult>& results) {
+    std::string json = "{\n  \"isa\": \"" + std::string(SimdISA()) + "\",\n  \"peak_rss_kb\": "
+        + std::to_string(PeakRSSKilobytes()) + ",\n  \"cases\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const SweepResult& r = results[i];
+        char line[256];
+        snprintf(line, sizeof(line),
+            "    {\"name\": \"%s\", \"pixels\": %zu, \"ns_per_pixel\": %.4f, \"pixels_per_sec\": %.0f, \"allocs_per_call\": %.2f, \"peak_rss_kb\": %zu}%s\n",
+            r.name.c_str(), r.pixels, r.nsPerPixel, r.pixelsPerSecond, r.allocsPerCall, r.peakRSS, i + 1 < results.size() ? "," : "");
+        json += line;
+    }
+    return json + "  ]\n}\n";
+}
+
+// value of "key": on a line, or false if the line has none
+static bool FindNumber(const char* line, const char* end, const char* key, double& value) {
+    std::string quoted = std::string("\"") + key + "\":";
+    const char* at = std::search(line, end, quoted.begin(), quoted.end());
+    if (at == end)
+    {
+        return false;
+    }
+    at += quoted.size();
+    while (at < end && *at == ' ') at++;
+    return std::from_chars(at, end, value).ec == std::errc();
+}
+
+static bool FindString(const char* line, const char* end, const char* key, std::string& value) {
+    std::string quoted = std::string("\"") + key + "\": \"";
+    const char* at = std::search(line, end, quoted.begin(), quoted.end());
+    if (at == end)
+    {
+        return false;
+    }
+    at += quoted.size();
+    const char* close = std::find(at, end, '"');
+    value.assign(at, close);
+    return close < end;
+}
+
+static bool LoadBaseline(const char* path, std::vector<SweepResult>& results) {
+    MappedFile file;
+    if (!file.open(path))
+    {
+        return false;
+    }
+    const char* p = file.data(), * end = p + file.size();
+    while (p < end) {
+        const char* eol = std::find(p, end, '\n');
+        SweepResult r = {};
+        double pixels, rss;
+        if (FindString(p, eol, "name", r.name) && FindNumber(p, eol, "ns_per_pixel", r.nsPerPixel)
+            && FindNumber(p, eol, "allocs_per_call", r.allocsPerCall) && FindNumber(p, eol, "pixels", pixels)
+            && FindNumber(p, eol, "peak_rss_kb", rss))
+        {
+            r.pixels = (size_t)pixels, r.peakRSS = (size_t)rss;
+            r.pixelsPerSecond = r.nsPerPixel > 0 ? 1e9 / r.nsPerPixel : 0;
+            results.push_back(r);
+        }
+        p = eol + 1;
+    }
+    return true;
+}
+
+// prints every case that got worse and returns how many did
+static size_t Compare(const std::vector<SweepResult>& baseline, const std::vector<SweepResult>& current, double threshold) {
+    size_t regressions = 0, matched = 0;
+    for (const SweepResult& now : current) {
+        auto old = std::find_if(baseline.begin(), baseline.end(), [&](const SweepResult& b) { return b.name == now.name; });
+        if (old == baseline.end())
+        {
+            continue;
+        }
+        matched++;
+        double change = old->nsPerPixel > 0 ? (now.nsPerPixel / old->nsPerPixel - 1) * 100 : 0;
+        bool slower = change > threshold;
+        bool allocates = now.allocsPerCall > old->allocsPerCall + 0.01;
+        bool pixels = now.pixels != old->pixels;
+        if (slower || allocates || pixels)
+        {
+            regressions++;
+            std::cerr << "REGRESSION " << now.name << ":";
+            if (slower) std::cerr << " " << old->nsPerPixel << " -> " << now.nsPerPixel << " ns/pixel (+" << change << "%)";
+            if (allocates) std::cerr << " " << old->allocsPerCall << " -> " << now.allocsPerCall << " allocs/call";
+            if (pixels) std::cerr << " " << old->pixels << " -> " << now.pixels << " pixels";
+            std::cerr << "\n";
+        }
+    }
+    std::cerr << matched << " of " << current.size() << " cases compared, " << regressions
+        << " regression(s) at a " << threshold << "% threshold\n";
+    return regressions;
+}
+
+
+int RunSweep(int argc, char** argv) {
+    const char* outPath = nullptr, * baselinePath = nullptr;
+    double threshold = 10, minSeconds = 0.02;
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else if (arg == "--compare" && i + 1 < argc) baselinePath = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc) threshold = std::atof(argv[++i]);
+        else if (arg == "--quick") minSeconds = 0.002;
+        else
+        {
+            std::cerr << "usage: sweep [--out file.json] [--compare baseline.json] [--threshold percent] [--quick]\n";
+            return 2;
+        }
+    }
+
+    std::vector<SweepResult> baseline;
+    if (baselinePath && !LoadBaseline(baselinePath, baseline))
+    {
+        std::cerr << "cannot read baseline " << baselinePath << "\n";
+        return 2;
+    }
+
+    std::vector<SweepResult> results = Sweep(minSeconds);
+    std::string json = ToJSON(results);
+    if (outPath)
+    {
+        FILE* file = fopen(outPath, "wb");
+        bool written = file && fwrite(json.data(), 1, json.size(), file) == json.size();
+        if (!file || fclose(file) != 0 || !written)
+        {
+            std::cerr << "cannot write " << outPath << "\n";
+            return 2;
+        }
+    }
+    else
+    {
+        std::cout << json;
+    }
+
+    return baselinePath && Compare(baseline, results, threshold) > 0 ? 1 : 0;
+}
@@ -0,0 +1,16 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+// Parameter sweep over DDA(), Bresenham(), MidpointCircle() and
+// MidpointEllipse(): line lengths and slopes, radii and eccentricities.
+// Every case reports ns/pixel, pixels/s, heap allocations per call and the
+// peak RSS so far, as JSON.
+//
+//   Lab2Bench sweep [--out file.json] [--compare baseline.json] [--threshold percent] [--quick]
+//
+// With --compare every case is checked against the same case in the
+// baseline. Cases that got slower by more than the threshold (10% by
+// default), or that allocate more, are flagged and the exit code is 1.
+int RunSweep(int argc, char** argv);
+
+#endif
@@ -0,0 +1,87 @@
+#include "uploadRing.h"
+#include <algorithm>
+
+using namespace std;
+
+
+UploadRing::UploadRing(size_t bytes, int segments)
+    : segments(std::min(std::max(segments, 1), 8)) {
+    perSegment = std::max<size_t>(bytes / this->segments / sizeof(Point), 1);
+}
+
+UploadRing::~UploadRing() {
+    release();
+}
+
+void UploadRing::release() {
+    for (GLsync& fence : fences) {
+        if (fence) glDeleteSync(fence);
+        fence = 0;
+    }
+    if (VAO)
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        VAO = VBO = 0;
+    }
+}
+
+size_t UploadRing::draw(PointGenerator& points, GLuint shader, float r, float g, float b, float pointSize) {
+    if (!VAO)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, perSegment * segments * sizeof(Point), NULL, GL_STREAM_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Point), (void*)0);
+        glEnableVertexAttribArray(0);
+    }
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glUseProgram(shader);
+    glUniform3f(glGetUniformLocation(shader, "color"), r, g, b);
+    glPointSize(pointSize);
+
+    size_t total = 0;
+    bool more = true;
+    while (more) {
+        int s = next;
+        if (fences[s])
+        {
+            // the GPU has to be done drawing this segment before it is overwritten
+            glClientWaitSync(fences[s], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fences[s]);
+            fences[s] = 0;
+        }
+
+        // unsynchronized: the fence already keeps the GPU off this range.
+        // The generator cannot be replayed, so when the driver refuses the
+        // map the points go through staging and glBufferSubData instead
+        GLintptr offset = s * perSegment * sizeof(Point);
+        Point* mapped = (Point*)glMapBufferRange(GL_ARRAY_BUFFER, offset, perSegment * sizeof(Point),
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (!mapped) staging.resize(perSegment);
+        Point* out = mapped ? mapped : staging.data();
+        size_t n = 0;
+        while (n < perSegment && (more = points.next(out[n]))) n++;
+        if (!mapped)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, offset, n * sizeof(Point), staging.data());
+        }
+        else if (!glUnmapBuffer(GL_ARRAY_BUFFER))
+        {
+            // the store was lost while mapped, and with it these points
+            n = 0;
+        }
+
+        if (n > 0)
+        {
+            glDrawArrays(GL_POINTS, (GLint)(s * perSegment), (GLsizei)n);
+            fences[s] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            next = (s + 1) % segments;
+            total += n;
+        }
+    }
+    return total;
+}
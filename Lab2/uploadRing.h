@@ -0,0 +1,37 @@
+#ifndef UPLOAD_RING_H
+#define UPLOAD_RING_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <cstddef>
+#include "pointStream.h"
+
+// One GL buffer of fixed size, split into segments that are filled and
+// drawn in turn. A segment is only written again after the GPU has drawn
+// it (one fence per segment), so the CPU fills the next segment while the
+// previous one is still being read, and a stream of any length needs no
+// more memory than the ring.
+class UploadRing {
+public:
+    explicit UploadRing(size_t bytes = UPLOAD_RING_BYTES, int segments = 4);
+    ~UploadRing();
+    UploadRing(const UploadRing&) = delete;
+    UploadRing& operator=(const UploadRing&) = delete;
+
+    // draws every point of the stream as GL_POINTS, the shader takes the
+    // position at location 0 and a color uniform. Returns the points drawn.
+    size_t draw(PointGenerator& points, GLuint shader, float r, float g, float b, float pointSize);
+
+    // deletes the GL objects, needs the context to still be current
+    void release();
+
+private:
+    size_t perSegment;              // points that fit in one segment
+    int segments;
+    int next = 0;                   // segment filled next
+    GLsync fences[8] = {};          // set while the GPU may still read a segment
+    std::vector<Point> staging;     // one segment, only if mapping ever fails
+    GLuint VAO = 0, VBO = 0;
+};
+
+#endif
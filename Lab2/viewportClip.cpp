@@ -0,0 +1,412 @@
+#include "viewportClip.h"
+#include <cfloat>
+#include <cstring>
+
+using namespace std;
+
+
+// STEP RANGES
+
+// first k in [lo, hi] that passes, hi + 1 if none does. Once a step
+// passes all later ones must too.
+template <typename Pass>
+static int64_t FirstPassing(int64_t lo, int64_t hi, Pass pass) {
+    int64_t end = hi + 1;
+    while (lo < end) {
+        int64_t mid = lo + (end - lo) / 2;
+        if (pass(mid)) end = mid; else lo = mid + 1;
+    }
+    return lo;
+}
+
+// narrows [first, last] to the steps whose coordinate c(k) lies in [lo, hi].
+// c(k) only grows along the walk for dir > 0 and only shrinks for dir < 0.
+template <typename Coord>
+static void ClipSteps(Coord c, int dir, float lo, float hi, int64_t& first, int64_t& last) {
+    if (first > last)
+    {
+        return;
+    }
+    int64_t a = first, b = last;
+    if (dir > 0)
+    {
+        first = FirstPassing(a, b, [&](int64_t k) { return c(k) >= lo; });
+        last = FirstPassing(a, b, [&](int64_t k) { return c(k) > hi; }) - 1;
+    }
+    else
+    {
+        first = FirstPassing(a, b, [&](int64_t k) { return c(k) <= hi; });
+        last = FirstPassing(a, b, [&](int64_t k) { return c(k) < lo; }) - 1;
+    }
+}
+
+
+// LINES
+
+BresenhamClip BresenhamWalk(int64_t ix1, int64_t iy1, int64_t ix2, int64_t iy2) {
+    // the same swaps as Bresenham()
+    int64_t dx = std::llabs(ix2 - ix1), dy = std::llabs(iy2 - iy1);
+    bool steep = dy > dx;
+    if (steep)
+    {
+        std::swap(ix1, iy1), std::swap(ix2, iy2), std::swap(dx, dy);
+    }
+    bool reversed = ix1 > ix2;
+    if (reversed)
+    {
+        std::swap(ix1, ix2), std::swap(iy1, iy2);
+    }
+    return { ix1, iy1, dx, dy, iy2 > iy1 ? 1 : -1, steep, reversed, 0, dx };
+}
+
+BresenhamClip ClipBresenham(int64_t ix1, int64_t iy1, int64_t ix2, int64_t iy2, const Viewport& view) {
+    BresenhamClip c = BresenhamWalk(ix1, iy1, ix2, iy2);
+    float majorMin = c.steep ? view.yMin : view.xMin, majorMax = c.steep ? view.yMax : view.xMax;
+    float minorMin = c.steep ? view.xMin : view.yMin, minorMax = c.steep ? view.xMax : view.yMax;
+
+    auto minor = [&](int64_t k) {
+        int64_t r;
+        return (float)(c.iy1 + c.yStep * BresenhamSteps(c.dx, c.dy, k, r));
+    };
+    ClipSteps([&](int64_t k) { return (float)(c.ix1 + k); }, 1, majorMin, majorMax, c.first, c.last);
+    ClipSteps(minor, (int)c.yStep, minorMin, minorMax, c.first, c.last);
+    return c;
+}
+
+FloatBresenhamClip ClipFloatBresenham(float x1, float y1, float x2, float y2, const Viewport& view) {
+    // the same swaps as Bresenham<LineMath::Float>()
+    float dx = std::abs(x2 - x1), dy = std::abs(y2 - y1);
+    bool steep = dy > dx;
+    if (steep)
+    {
+        std::swap(x1, y1), std::swap(x2, y2), std::swap(dx, dy);
+    }
+    if (x1 > x2)
+    {
+        std::swap(x1, x2), std::swap(y1, y2);
+    }
+    // x runs from x1 while it is at most x2, steps past 2^53 could not be told apart
+    double steps = std::min(std::floor((double)x2 - x1), std::ldexp(1.0, 53));
+    FloatBresenhamClip c = { x1, y1, dx, dy, y2 > y1 ? 1.0 : -1.0, steep, 0, steps >= 0 ? (int64_t)steps : -1 };
+
+    float majorMin = c.steep ? view.yMin : view.xMin, majorMax = c.steep ? view.yMax : view.xMax;
+    float minorMin = c.steep ? view.xMin : view.yMin, minorMax = c.steep ? view.xMax : view.yMax;
+    ClipSteps([&](int64_t k) { return (float)(c.x1 + (double)k); }, 1, majorMin, majorMax, c.first, c.last);
+    ClipSteps([&](int64_t k) { return (float)(c.y1 + c.yStep * FloatBresenhamSteps(c, k)); },
+        (int)c.yStep, minorMin, minorMax, c.first, c.last);
+    return c;
+}
+
+DDAClip ClipDDA(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const Viewport& view) {
+    DDAClip c;
+    c.xs = x1, c.ys = y1;
+    c.dx = x2 - x1, c.dy = y2 - y1;
+    c.sx = c.dx < 0 ? -1 : 1, c.sy = c.dy < 0 ? -1 : 1;
+    c.dx *= c.sx, c.dy *= c.sy;
+    c.steps = std::max(c.dx, c.dy);
+    c.first = 0, c.last = c.steps;
+
+    // the carried remainders keep the 16.16 sum of DDA() at exactly
+    // 1/2 + floor(k * d * 2^16 / steps) after k steps
+    auto offset = [&](int64_t k, int32_t d) {
+        return c.steps > 0 ? (0x8000 + k * ((int64_t)d << 16) / c.steps) >> 16 : 0;
+    };
+    ClipSteps([&](int64_t k) { return (float)(c.xs + c.sx * offset(k, c.dx)); }, c.sx, view.xMin, view.xMax, c.first, c.last);
+    ClipSteps([&](int64_t k) { return (float)(c.ys + c.sy * offset(k, c.dy)); }, c.sy, view.yMin, view.yMax, c.first, c.last);
+    return c;
+}
+
+void ClipDDAReference(float x1, float y1, float x2, float y2, const Viewport& view, int64_t& first, int64_t& last) {
+    double dx = x2 - x1, dy = y2 - y1;
+    double steps = std::max(std::abs(dx), std::abs(dy));
+    first = 0, last = steps >= 0 ? (int64_t)steps : -1;
+
+    // i * d is exact and dividing and rounding never reverse an order
+    ClipSteps([&](int64_t i) { return (float)(x1 + std::round(steps > 0 ? i * dx / steps : 0)); },
+        dx < 0 ? -1 : 1, view.xMin, view.xMax, first, last);
+    ClipSteps([&](int64_t i) { return (float)(y1 + std::round(steps > 0 ? i * dy / steps : 0)); },
+        dy < 0 ? -1 : 1, view.yMin, view.yMax, first, last);
+}
+
+// float x after n steps of x += inc. Within a binade every sum rounds to
+// the same grid, so once a step has stayed inside one the rest move by that
+// much too, up to its edge, and are taken in one multiplication. A step
+// that is a tie between two grid points rounds to even, which can differ
+// for the first one, so those wait for a second equal step. Subnormal sums
+// are exact, all of them one binade.
+static float FloatSum(float x, float inc, int64_t n) {
+    // sign and exponent bits, 0 for every subnormal
+    auto binade = [](float v) {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof bits);
+        return (bits & 0x7f800000) ? bits >> 23 : 0;
+    };
+    float from = x;
+    double previous = 0;
+    while (n > 0) {
+        float next = x + inc;
+        double step = (double)next - x;
+        uint32_t b = binade(x);
+        bool inside = b == binade(next), again = inside && step == previous && binade(from) == b;
+        from = x, x = next, previous = step, n--;
+        if (step == 0)
+        {
+            break;
+        }
+        if (!inside)
+        {
+            continue;
+        }
+
+        // the binade's grid spacing and what is left of it in the direction
+        // x moves, short of the last step and a spacing
+        double a = std::abs((double)x), spacing = std::ldexp(1.0, -149), room;
+        if (b == 0)
+        {
+            room = FLT_MIN - (step > 0 ? (double)x : -(double)x);
+        }
+        else
+        {
+            double low = std::ldexp(1.0, (int)(b & 0xff) - 127);
+            spacing = low * std::ldexp(1.0, -23);
+            room = (step > 0) == (x > 0) ? 2 * low - a : a - low;
+        }
+        double units = std::abs((double)inc) / spacing;
+        if (units - std::floor(units) == 0.5 && !again)
+        {
+            continue;
+        }
+        double k = std::floor((room - spacing - std::max(std::abs(step), (double)std::abs(inc))) / std::abs(step));
+        if (k > 0)
+        {
+            k = std::min(k, (double)n);
+            x = (float)(x + k * step), n -= (int64_t)k;
+        }
+    }
+    return x;
+}
+
+FloatDDAClip ClipFloatDDA(float x1, float y1, float x2, float y2, const Viewport& view) {
+    // the same increments as DDA<LineMath::Float>()
+    float dx = x2 - x1, dy = y2 - y1;
+    float steps = std::max(std::abs(dx), std::abs(dy));
+    FloatDDAClip c = { x1, y1, dx / steps, dy / steps, 0, -1 };
+    // a single point divides by zero and walks NaN, which no view contains
+    if (steps > 0)
+    {
+        c.last = (int64_t)std::min(std::floor((double)steps), std::ldexp(1.0, 53));
+    }
+
+    ClipSteps([&](int64_t i) { return std::round(FloatSum(x1, c.xInc, i)); },
+        c.xInc < 0 ? -1 : 1, view.xMin, view.xMax, c.first, c.last);
+    ClipSteps([&](int64_t i) { return std::round(FloatSum(y1, c.yInc, i)); },
+        c.yInc < 0 ? -1 : 1, view.yMin, view.yMax, c.first, c.last);
+    if (c.first <= c.last)
+    {
+        c.x = FloatSum(x1, c.xInc, c.first), c.y = FloatSum(y1, c.yInc, c.first);
+    }
+    return c;
+}
+
+// as for the whole line (primitives.cpp), about a run per row or column
+// the visible part crosses, and never more runs than visible steps
+static size_t ClippedSpanBound(float x1, float y1, float x2, float y2, const Viewport& view, size_t steps) {
+    double columns = std::min(std::ceil(std::abs((double)x2 - x1)), (double)view.xMax - view.xMin) + 3;
+    double rows = std::min(std::ceil(std::abs((double)y2 - y1)), (double)view.yMax - view.yMin) + 3;
+    return std::min(steps, (size_t)std::max(std::min(columns, rows), 0.0));
+}
+
+std::vector<Span> DDASpans(float x1, float y1, float x2, float y2, const Viewport& view) {
+    std::vector<Span> spans;
+    spans.reserve(ClippedSpanBound(x1, y1, x2, y2, view, DDACount(x1, y1, x2, y2, view)));
+    SpanBuilder builder(spans);
+    DDA(x1, y1, x2, y2, view, builder);
+    builder.finish();
+    return spans;
+}
+
+std::vector<Span> BresenhamSpans(float x1, float y1, float x2, float y2, const Viewport& view) {
+    std::vector<Span> spans;
+    spans.reserve(ClippedSpanBound(x1, y1, x2, y2, view, BresenhamCount(x1, y1, x2, y2, view)));
+    SpanBuilder builder(spans);
+    Bresenham(x1, y1, x2, y2, view, builder);
+    builder.finish();
+    return spans;
+}
+
+
+// COUNTS
+
+template <>
+size_t DDACount<LineMath::Float>(float x1, float y1, float x2, float y2, const Viewport& view) {
+    if (LineInside(x1, y1, x2, y2, view))
+    {
+        return DDACount<LineMath::Float>(x1, y1, x2, y2);
+    }
+    FloatDDAClip c = ClipFloatDDA(x1, y1, x2, y2, view);
+    return c.first <= c.last ? (size_t)(c.last - c.first + 1) : 0;
+}
+
+template <>
+size_t DDACount<LineMath::Integer>(float x1, float y1, float x2, float y2, const Viewport& view) {
+    if (LineInside(x1, y1, x2, y2, view))
+    {
+        return DDACount<LineMath::Integer>(x1, y1, x2, y2);
+    }
+    int64_t first, last;
+    if (!FitsInt32Line(x1, y1, x2, y2))
+    {
+        ClipDDAReference(std::round(x1), std::round(y1), std::round(x2), std::round(y2), view, first, last);
+        return first <= last ? (size_t)(last - first + 1) : 0;
+    }
+    long long lx1 = llround(x1), ly1 = llround(y1), lx2 = llround(x2), ly2 = llround(y2);
+    if (!FitsFixed16(lx1, ly1, lx2, ly2))
+    {
+        ClipDDAReference((float)lx1, (float)ly1, (float)lx2, (float)ly2, view, first, last);
+    }
+    else
+    {
+        DDAClip c = ClipDDA((int32_t)lx1, (int32_t)ly1, (int32_t)lx2, (int32_t)ly2, view);
+        first = c.first, last = c.last;
+    }
+    return first <= last ? (size_t)(last - first + 1) : 0;
+}
+
+template <>
+size_t BresenhamCount<LineMath::Integer>(float x1, float y1, float x2, float y2, const Viewport& view) {
+    if (LineInside(x1, y1, x2, y2, view))
+    {
+        return BresenhamCount<LineMath::Integer>(x1, y1, x2, y2);
+    }
+    if (!FitsInt32Line(x1, y1, x2, y2))
+    {
+        FloatBresenhamClip c = ClipFloatBresenham(std::round(x1), std::round(y1), std::round(x2), std::round(y2), view);
+        return c.first <= c.last ? (size_t)(c.last - c.first + 1) : 0;
+    }
+    BresenhamClip c = ClipBresenham(llround(x1), llround(y1), llround(x2), llround(y2), view);
+    return c.first <= c.last ? (size_t)(c.last - c.first + 1) : 0;
+}
+
+template <>
+size_t BresenhamCount<LineMath::Float>(float x1, float y1, float x2, float y2, const Viewport& view) {
+    if (LineInside(x1, y1, x2, y2, view))
+    {
+        return BresenhamCount<LineMath::Float>(x1, y1, x2, y2);
+    }
+    if (WholeFloatLine(x1, y1, x2, y2))
+    {
+        return BresenhamCount<LineMath::Integer>(x1, y1, x2, y2, view);
+    }
+    FloatBresenhamClip c = ClipFloatBresenham(x1, y1, x2, y2, view);
+    return c.first <= c.last ? (size_t)(c.last - c.first + 1) : 0;
+}
+
+
+// CIRCLES AND ELLIPSES
+
+int CircleOctants(float xc, float yc, float r, const Viewport& view) {
+    // directions of the octant boundaries at 0, 45, ..., 360 degrees
+    const double s = 0.70710678118654752;
+    const double cx[9] = { 1, s, 0, -s, -1, -s, 0, s, 1 };
+    const double cy[9] = { 0, s, 1, s, 0, -s, -1, -s, 0 };
+    double radius = std::abs(r);
+
+    int octants = 0;
+    for (int k = 0; k < 8; k++) {
+        // an octant never reaches past an axis, so its box is spanned by its two ends
+        double x1 = xc + radius * std::min(cx[k], cx[k + 1]) - 1, x2 = xc + radius * std::max(cx[k], cx[k + 1]) + 1;
+        double y1 = yc + radius * std::min(cy[k], cy[k + 1]) - 1, y2 = yc + radius * std::max(cy[k], cy[k + 1]) + 1;
+        if (view.overlaps(x1, y1, x2, y2))
+        {
+            octants |= 1 << k;
+        }
+    }
+    return octants;
+}
+
+int EllipseQuadrants(float xc, float yc, float rx, float ry, const Viewport& view) {
+    double w = std::abs(rx) + 1.0, h = std::abs(ry) + 1.0;
+    double a2 = (double)rx * rx, b2 = (double)ry * ry;
+    auto inside = [&](double x, double y) { return x * x / a2 + y * y / b2 < 1; };
+
+    int quadrants = 0;
+    for (int q = 0; q < 4; q++) {
+        // the part of the view over the quadrant's box, relative to the centre and mirrored into the first
+        double x1 = std::max(q & 1 ? (double)xc - view.xMax : (double)view.xMin - xc, -1.0);
+        double x2 = std::min(q & 1 ? (double)xc - view.xMin : (double)view.xMax - xc, w);
+        double y1 = std::max(q & 2 ? (double)yc - view.yMax : (double)view.yMin - yc, -1.0);
+        double y2 = std::min(q & 2 ? (double)yc - view.yMin : (double)view.yMax - yc, h);
+        if (x1 > x2 || y1 > y2)
+        {
+            continue;
+        }
+        // Moved diagonally towards the curve by half a pixel, and away from
+        // the centre by one, every pixel of the walk reaches the true ellipse.
+        // So a part that stays outside it with two pixels to spare, or inside
+        // with one, holds none, however long the arc that passes it.
+        if (rx > 2 && ry > 2)
+        {
+            if (!inside(std::max(x1 - 2, 0.0), std::max(y1 - 2, 0.0)) || inside(x2 + 1, y2 + 1))
+            {
+                continue;
+            }
+        }
+        quadrants |= 1 << q;
+    }
+    return quadrants;
+}
+
+size_t MidpointCircleUniqueCount(float xc, float yc, float r, const Viewport& view) {
+    if (ShapeInside(xc, yc, r + 1, r + 1, view))
+    {
+        return MidpointCircleUniqueCount(r);
+    }
+    CountingSink counter;
+    MidpointCircleUnique(xc, yc, r, view, counter);
+    return counter.count;
+}
+
+size_t MidpointEllipseUniqueCount(float xc, float yc, float rx, float ry, const Viewport& view) {
+    if (ShapeInside(xc, yc, rx, ry, view))
+    {
+        return MidpointEllipseUniqueCount(rx, ry);
+    }
+    CountingSink counter;
+    MidpointEllipseUnique(xc, yc, rx, ry, view, counter);
+    return counter.count;
+}
+
+
+// ANTIALIASED LINES
+
+std::vector<CoveragePoint> WuLine(float x1, float y1, float x2, float y2, Viewport view) {
+    std::vector<CoveragePoint> points;
+    struct Collect {
+        std::vector<CoveragePoint>& out;
+        void put(float x, float y, float coverage) { out.push_back({ x, y, coverage }); }
+    } sink{ points };
+    WuLine(x1, y1, x2, y2, view, sink);
+    return points;
+}
+
+
+// FILLED SHAPES
+
+struct SpanCollector {
+    std::vector<Span>& out;
+    void put(const Span& s) { out.push_back(s); }
+};
+
+std::vector<Span> FilledCircle(float xc, float yc, float r, Viewport view) {
+    std::vector<Span> spans;
+    SpanCollector sink{ spans };
+    FilledCircle(xc, yc, r, view, sink);
+    return spans;
+}
+
+std::vector<Span> FilledEllipse(float xc, float yc, float rx, float ry, Viewport view) {
+    std::vector<Span> spans;
+    SpanCollector sink{ spans };
+    FilledEllipse(xc, yc, rx, ry, view, sink);
+    return spans;
+}
@@ -0,0 +1,490 @@
+#ifndef VIEWPORT_CLIP_H
+#define VIEWPORT_CLIP_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "primitives.h"
+#include "wuLine.h"
+
+// Clipped versions of the Lab2 generators. Each emits the pixels of its
+// unclipped counterpart that lie inside a viewport, in the same order, but
+// works out where the visible part of the walk begins and ends before
+// stepping. A line entered with far-off end points then costs its visible
+// pixels plus a few binary search steps, not a step per pixel of its whole
+// length. Circles and ellipses skip the octants and quadrants that miss the
+// view and test the pixels of the others.
+
+// pixels with x in [xMin, xMax] and y in [yMin, yMax], both ends included
+struct Viewport {
+    float xMin, yMin, xMax, yMax;
+
+    bool contains(float x, float y) const { return x >= xMin && x <= xMax && y >= yMin && y <= yMax; }
+    // whether the box [x1, x2] * [y1, y2] reaches into the view
+    bool overlaps(double x1, double y1, double x2, double y2) const {
+        return x2 >= xMin && x1 <= xMax && y2 >= yMin && y1 <= yMax;
+    }
+    // whether the box lies inside the view entirely
+    bool covers(double x1, double y1, double x2, double y2) const {
+        return x1 >= xMin && x2 <= xMax && y1 >= yMin && y2 <= yMax;
+    }
+};
+
+// the window as the 2 pixel GL points see it: a point at x covers pixels
+// x - 1 and x, so points on the far edge x = WIDTH still show
+const Viewport SCREEN_VIEWPORT = { 0, 0, WIDTH, HEIGHT };
+
+// passes on only the pixels inside the view, for walks that cannot skip ahead
+template <typename Sink>
+struct ViewportSink {
+    const Viewport& view;
+    Sink& sink;
+
+    void put(float x, float y) {
+        if (view.contains(x, y))
+        {
+            sink.put(x, y);
+        }
+    }
+};
+
+
+// LINES
+// Along a line walk both coordinates only ever move one way, so the steps
+// inside the view are a single range [first, last], found by binary search
+// over the closed form position of step k.
+
+// the integer Bresenham walk after its swaps: the major coordinate is
+// ix1 + k, the minor one iy1 + yStep * m(k), and steps first..last are
+// visible. Everything is int64, so any int32 end points walk exactly.
+struct BresenhamClip {
+    int64_t ix1, iy1, dx, dy, yStep;
+    bool steep;
+    bool reversed;      // the walk starts at the second end point
+    int64_t first, last;
+};
+// the whole walk, steps 0..dx
+BresenhamClip BresenhamWalk(int64_t ix1, int64_t iy1, int64_t ix2, int64_t iy2);
+BresenhamClip ClipBresenham(int64_t ix1, int64_t iy1, int64_t ix2, int64_t iy2, const Viewport& view);
+
+// the rounded end points are int32 values, which the int64 walk takes exactly
+inline bool FitsInt32Line(float x1, float y1, float x2, float y2) {
+    auto fits = [](float v) { return std::abs(v) < 2147483648.0f; };
+    return fits(x1) && fits(y1) && fits(x2) && fits(y2);
+}
+
+// y has stepped m(k) = floor((2 dy k + dx) / 2 dx) times before step k,
+// the number of times the error term reached zero, and r is what is left,
+// 2 dy k + dx - 2 dx m(k). 2 dy k passes 2^63 on deltas near 2^32, so the
+// quotient is estimated in double, which is off by at most one, and the
+// remainder comes out exact in wrapping arithmetic because it is small.
+inline int64_t BresenhamSteps(int64_t dx, int64_t dy, int64_t k, int64_t& r) {
+    if (dx == 0)
+    {
+        r = 0;
+        return 0;
+    }
+    int64_t d = 2 * dx;
+    int64_t m = (int64_t)std::floor((2.0 * dy * k + dx) / d);
+    r = (int64_t)(2 * (uint64_t)dy * (uint64_t)k + (uint64_t)dx - (uint64_t)m * (uint64_t)d);
+    for (; r < 0; m--) r += d;
+    for (; r >= d; m++) r -= d;
+    return m;
+}
+
+// walks steps k0..k1 of c, starting from the closed form of the error term
+// at k0 instead of walking up to it
+template <typename Sink>
+void BresenhamRun(const BresenhamClip& c, int64_t k0, int64_t k1, Sink& sink) {
+    int64_t r, m = BresenhamSteps(c.dx, c.dy, k0, r);
+    // the error term before step k0 is 2 dy (k0 + 1) - dx - 2 dx m(k0)
+    int64_t y = c.iy1 + c.yStep * m, p = r + 2 * c.dy - 2 * c.dx;
+    for (int64_t x = c.ix1 + k0; x <= c.ix1 + k1; x++) {
+        c.steep ? sink.put((float)y, (float)x) : sink.put((float)x, (float)y);
+        if (p >= 0) y += c.yStep, p -= 2 * c.dx;
+        p += 2 * c.dy;
+    }
+}
+
+// The float Bresenham walk after its swaps, in exact arithmetic, for end
+// points the integer walk cannot take: step k is at x1 + k and y1 + yStep
+// * m(k), with m(k) as above for real dx and dy. The float walk rounds its
+// error term, so where that term comes out within rounding of zero it can
+// step a row earlier or later than this.
+struct FloatBresenhamClip {
+    double x1, y1, dx, dy, yStep;
+    bool steep;
+    int64_t first, last;
+};
+FloatBresenhamClip ClipFloatBresenham(float x1, float y1, float x2, float y2, const Viewport& view);
+
+inline double FloatBresenhamSteps(const FloatBresenhamClip& c, int64_t k) {
+    return c.dx > 0 ? std::floor((2 * c.dy * (double)k + c.dx) / (2 * c.dx)) : 0;
+}
+
+// computes every visible step from its closed form, so it always agrees
+// with the search that found them
+template <typename Sink>
+void FloatBresenhamRun(const FloatBresenhamClip& c, Sink& sink) {
+    for (int64_t k = c.first; k <= c.last; k++) {
+        float x = (float)(c.x1 + (double)k), y = (float)(c.y1 + c.yStep * FloatBresenhamSteps(c, k));
+        c.steep ? sink.put(y, x) : sink.put(x, y);
+    }
+}
+
+// the 16.16 DDA walk, steps first..last are visible
+struct DDAClip {
+    int32_t xs, ys, sx, sy, dx, dy, steps;
+    int64_t first, last;
+};
+DDAClip ClipDDA(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const Viewport& view);
+
+// steps of DDAReference() that are visible
+void ClipDDAReference(float x1, float y1, float x2, float y2, const Viewport& view, int64_t& first, int64_t& last);
+
+// The float Bresenham with whole end points does exactly what the integer
+// one does, as long as 2 * dx stays exact in a float
+inline bool WholeFloatLine(float x1, float y1, float x2, float y2) {
+    auto whole = [](float v) { return std::floor(v) == v && std::abs(v) <= (1 << 21); };
+    return whole(x1) && whole(y1) && whole(x2) && whole(y2);
+}
+
+// the rounded end points' box, grown by one pixel, lies in the view, so nothing needs clipping
+inline bool LineInside(float x1, float y1, float x2, float y2, const Viewport& view) {
+    return view.covers(std::min(x1, x2) - 1.0, std::min(y1, y2) - 1.0, std::max(x1, x2) + 1.0, std::max(y1, y2) + 1.0);
+}
+
+template <typename Sink>
+void DDAReference(float x1, float y1, float x2, float y2, const Viewport& view, Sink& sink) {
+    int64_t first, last;
+    ClipDDAReference(x1, y1, x2, y2, view, first, last);
+    double dx = x2 - x1, dy = y2 - y1;
+    double steps = std::max(std::abs(dx), std::abs(dy));
+    for (int64_t i = first; i <= last; i++) {
+        double ox = steps > 0 ? i * dx / steps : 0, oy = steps > 0 ? i * dy / steps : 0;
+        sink.put((float)(x1 + std::round(ox)), (float)(y1 + std::round(oy)));
+    }
+}
+
+// The float DDA rounds every sum to float, so step i is not simply at
+// x1 + i * xInc. Inside one binade all those sums round to the same grid
+// and move by the same amount, though, so the sum after i steps is found
+// with a few additions per binade it passes, which the search for the
+// visible steps pays per probe. Those steps are then summed as DDA() does.
+struct FloatDDAClip {
+    float x, y;             // both sums at step first
+    float xInc, yInc;
+    int64_t first, last;
+};
+FloatDDAClip ClipFloatDDA(float x1, float y1, float x2, float y2, const Viewport& view);
+
+template <typename Sink>
+void FloatDDA(float x1, float y1, float x2, float y2, const Viewport& view, Sink& sink) {
+    FloatDDAClip c = ClipFloatDDA(x1, y1, x2, y2, view);
+    float x = c.x, y = c.y;
+    for (int64_t i = c.first; i <= c.last; i++) {
+        sink.put(std::round(x), std::round(y));
+        x += c.xInc; y += c.yInc;
+    }
+}
+
+template <LineMath M = LineMath::Float, typename Sink>
+void DDA(float x1, float y1, float x2, float y2, const Viewport& view, Sink& sink) {
+    if (LineInside(x1, y1, x2, y2, view))
+    {
+        DDA<M>(x1, y1, x2, y2, sink);
+        return;
+    }
+    if (M == LineMath::Float)
+    {
+        FloatDDA(x1, y1, x2, y2, view, sink);
+        return;
+    }
+
+    if (!FitsInt32Line(x1, y1, x2, y2))
+    {
+        DDAReference(std::round(x1), std::round(y1), std::round(x2), std::round(y2), view, sink);
+        return;
+    }
+    long long lx1 = std::llround(x1), ly1 = std::llround(y1), lx2 = std::llround(x2), ly2 = std::llround(y2);
+    if (!FitsFixed16(lx1, ly1, lx2, ly2))
+    {
+        DDAReference((float)lx1, (float)ly1, (float)lx2, (float)ly2, view, sink);
+        return;
+    }
+
+    // resume the 16.16 sums of DDA() at the first visible step
+    DDAClip c = ClipDDA((int32_t)lx1, (int32_t)ly1, (int32_t)lx2, (int32_t)ly2, view);
+    if (c.first > c.last)
+    {
+        return;
+    }
+    if (c.steps == 0)
+    {
+        sink.put((float)c.xs, (float)c.ys);
+        return;
+    }
+    int64_t xTotal = c.first * ((int64_t)c.dx << 16), yTotal = c.first * ((int64_t)c.dy << 16);
+    int32_t ax = 0x8000 + (int32_t)(xTotal / c.steps), ay = 0x8000 + (int32_t)(yTotal / c.steps);
+    int32_t xErr = (int32_t)(xTotal % c.steps), yErr = (int32_t)(yTotal % c.steps);
+    int32_t xInc = (c.dx << 16) / c.steps, xRem = (c.dx << 16) % c.steps;
+    int32_t yInc = (c.dy << 16) / c.steps, yRem = (c.dy << 16) % c.steps;
+
+    for (int32_t i = (int32_t)c.first; i <= c.last; i++) {
+        sink.put((float)(c.xs + c.sx * (ax >> 16)), (float)(c.ys + c.sy * (ay >> 16)));
+        ax += xInc, xErr += xRem;
+        if (xErr >= c.steps) ax++, xErr -= c.steps;
+        ay += yInc, yErr += yRem;
+        if (yErr >= c.steps) ay++, yErr -= c.steps;
+    }
+}
+
+template <LineMath M = LineMath::Float, typename Sink>
+void Bresenham(float x1, float y1, float x2, float y2, const Viewport& view, Sink& sink) {
+    if (LineInside(x1, y1, x2, y2, view))
+    {
+        Bresenham<M>(x1, y1, x2, y2, sink);
+        return;
+    }
+    if (M == LineMath::Float ? !WholeFloatLine(x1, y1, x2, y2) : !FitsInt32Line(x1, y1, x2, y2))
+    {
+        FloatBresenhamRun(M == LineMath::Float ? ClipFloatBresenham(x1, y1, x2, y2, view) :
+            ClipFloatBresenham(std::round(x1), std::round(y1), std::round(x2), std::round(y2), view), sink);
+        return;
+    }
+
+    // resume the walk of Bresenham() at the first visible step
+    BresenhamClip c = ClipBresenham(std::llround(x1), std::llround(y1), std::llround(x2), std::llround(y2), view);
+    BresenhamRun(c, c.first, c.last, sink);
+}
+
+// span mode of the clipped walks, the runs are cut where the view cuts the line
+std::vector<Span> DDASpans(float x1, float y1, float x2, float y2, const Viewport& view);
+std::vector<Span> BresenhamSpans(float x1, float y1, float x2, float y2, const Viewport& view);
+
+template <LineMath M = LineMath::Float>
+size_t DDACount(float x1, float y1, float x2, float y2, const Viewport& view);
+template <LineMath M = LineMath::Float>
+size_t BresenhamCount(float x1, float y1, float x2, float y2, const Viewport& view);
+
+template <> size_t DDACount<LineMath::Float>(float x1, float y1, float x2, float y2, const Viewport& view);
+template <> size_t DDACount<LineMath::Integer>(float x1, float y1, float x2, float y2, const Viewport& view);
+template <> size_t BresenhamCount<LineMath::Float>(float x1, float y1, float x2, float y2, const Viewport& view);
+template <> size_t BresenhamCount<LineMath::Integer>(float x1, float y1, float x2, float y2, const Viewport& view);
+
+
+// ANTIALIASED LINES
+// WuLine() only computes the columns whose pixel pair can reach the view:
+// the major axis bounds them directly, the minor one through the gradient
+// with a column to spare either side, and those pixels are tested one by one.
+
+template <typename Sink>
+void WuLine(float x1, float y1, float x2, float y2, const Viewport& view, Sink& sink) {
+    // the end columns can put their second pixel up to 2 past the end point
+    if (view.covers(std::min(x1, x2) - 2.0, std::min(y1, y2) - 2.0, std::max(x1, x2) + 2.0, std::max(y1, y2) + 2.0))
+    {
+        WuLine(x1, y1, x2, y2, sink);
+        return;
+    }
+    WuLineSetup s = SetupWuLine(x1, y1, x2, y2);
+    auto put = [&](float x, float y, float coverage) {
+        if (s.steep) std::swap(x, y);
+        if (view.contains(x, y)) sink.put(x, y, coverage);
+    };
+    auto column = [&](float x, float y, float weight) {
+        float iy = std::floor(y), f = y - iy;
+        put(x, iy, (1 - f) * weight);
+        put(x, iy + 1, f * weight);
+    };
+
+    if (s.xStart == s.xEnd)
+    {
+        column(s.xStart, s.yStart, 1);
+        return;
+    }
+    column(s.xStart, s.yStart, s.gapStart);
+
+    // the view in the axes of the walk
+    double majorMin = s.steep ? view.yMin : view.xMin, majorMax = s.steep ? view.yMax : view.xMax;
+    double minorMin = s.steep ? view.xMin : view.yMin, minorMax = s.steep ? view.xMax : view.yMax;
+    double lo = std::max(1.0, std::ceil(majorMin - s.xStart)), hi = std::min((double)s.inner, std::floor(majorMax - s.xStart));
+    if (s.gradient != 0)
+    {
+        // the pixel pair reaches the view while y(k) is in [minorMin - 1, minorMax + 1)
+        double a = (minorMin - 1 - s.yStart) / s.gradient, b = (minorMax + 1 - s.yStart) / s.gradient;
+        lo = std::max(lo, std::floor(std::min(a, b)) - 1), hi = std::min(hi, std::ceil(std::max(a, b)) + 1);
+    }
+    for (int64_t k = (int64_t)lo; lo <= hi && k <= (int64_t)hi; k++) {
+        column(s.xStart + (float)k, s.yStart + s.gradient * (float)k, 1);
+    }
+    column(s.xEnd, s.yEnd, s.gapEnd);
+}
+
+// the view is taken by value so a non-const one does not pick the sink template
+std::vector<CoveragePoint> WuLine(float x1, float y1, float x2, float y2, Viewport view);
+
+
+// CIRCLES AND ELLIPSES
+// Every octant of a circle is checked against the view with its bounding
+// box, grown by a pixel, and offscreen ones are not walked at all. An
+// ellipse quadrant's box holds the centre, so its view part is also checked
+// against the curve itself, and a big ellipse around the view is dropped.
+// The walks that are left still test their pixels one by one.
+
+// bit k is set when octant k (45k..45(k + 1) degrees, as in
+// MidpointCircleOctant()) of the circle may have pixels in the view
+int CircleOctants(float xc, float yc, float r, const Viewport& view);
+// bit 0 for +x +y, 1 for -x +y, 2 for +x -y, 3 for -x -y, the order MidpointEllipse() puts them in
+int EllipseQuadrants(float xc, float yc, float rx, float ry, const Viewport& view);
+
+// the shape's box, grown by one pixel, lies in the view, so nothing needs clipping
+inline bool ShapeInside(float xc, float yc, float rx, float ry, const Viewport& view) {
+    double w = std::abs(rx) + 1.0, h = std::abs(ry) + 1.0;
+    return view.covers(xc - w, yc - h, xc + w, yc + h);
+}
+
+template <typename Sink>
+void MidpointCircle(float xc, float yc, float r, const Viewport& view, Sink& sink) {
+    if (ShapeInside(xc, yc, r, r, view))
+    {
+        MidpointCircle(xc, yc, r, sink);
+        return;
+    }
+    int o = CircleOctants(xc, yc, r, view);
+    if (!o)
+    {
+        return;
+    }
+    ViewportSink<Sink> clip{ view, sink };
+    MidpointCircleWalk(r, [&](float x, float y) {
+        if (o & 0x02) clip.put(xc + x, yc + y);
+        if (o & 0x04) clip.put(xc - x, yc + y);
+        if (o & 0x40) clip.put(xc + x, yc - y);
+        if (o & 0x20) clip.put(xc - x, yc - y);
+        if (o & 0x01) clip.put(xc + y, yc + x);
+        if (o & 0x08) clip.put(xc - y, yc + x);
+        if (o & 0x80) clip.put(xc + y, yc - x);
+        if (o & 0x10) clip.put(xc - y, yc - x);
+    });
+}
+
+template <typename Sink>
+void MidpointCircleUnique(float xc, float yc, float fr, const Viewport& view, Sink& sink) {
+    if (ShapeInside(xc, yc, fr + 1, fr + 1, view))
+    {
+        MidpointCircleUnique(xc, yc, fr, sink);
+        return;
+    }
+    int64_t r = (int64_t)std::llround(fr);
+    if (r <= 0)
+    {
+        if (r == 0 && view.contains(xc, yc)) sink.put(xc, yc);
+        return;
+    }
+    int o = CircleOctants(xc, yc, (float)r, view);
+    ViewportSink<Sink> clip{ view, sink };
+    for (int octant = 0; octant < 8; octant++) {
+        if (o & (1 << octant))
+        {
+            MidpointCircleOctant(r, octant, [&](int64_t dx, int64_t dy) { clip.put(xc + (float)dx, yc + (float)dy); });
+        }
+    }
+}
+
+template <typename Sink>
+void MidpointEllipse(float xc, float yc, float rx, float ry, const Viewport& view, Sink& sink) {
+    if (ShapeInside(xc, yc, rx, ry, view))
+    {
+        MidpointEllipse(xc, yc, rx, ry, sink);
+        return;
+    }
+    int q = EllipseQuadrants(xc, yc, rx, ry, view);
+    if (!q)
+    {
+        return;
+    }
+    ViewportSink<Sink> clip{ view, sink };
+    MidpointEllipseQuadrant(rx, ry, [&](float x, float y) {
+        if (q & 1) clip.put(xc + x, yc + y);
+        if (q & 2) clip.put(xc - x, yc + y);
+        if (q & 4) clip.put(xc + x, yc - y);
+        if (q & 8) clip.put(xc - x, yc - y);
+    });
+}
+
+template <typename Sink>
+void MidpointEllipseUnique(float xc, float yc, float rx, float ry, const Viewport& view, Sink& sink) {
+    if (ShapeInside(xc, yc, rx, ry, view))
+    {
+        MidpointEllipseUnique(xc, yc, rx, ry, sink);
+        return;
+    }
+    int q = EllipseQuadrants(xc, yc, rx, ry, view);
+    if (!q)
+    {
+        return;
+    }
+    ViewportSink<Sink> clip{ view, sink };
+    MidpointEllipseUniqueWalk(rx, ry, q, [&](float x, float y) { clip.put(xc + x, yc + y); });
+}
+
+// Filled shapes whose box misses the view are dropped unwalked. The others
+// walk their rows as before, rows outside the view are dropped and the
+// rest cut to it, keeping to the pixel grid of the shape.
+template <typename Sink>
+struct ViewportSpanSink {
+    const Viewport& view;
+    Sink& sink;
+
+    void put(const Span& s) {
+        if (s.y1 < view.yMin || s.y1 > view.yMax)
+        {
+            return;
+        }
+        float x1 = s.x1 < view.xMin ? s.x1 + std::ceil(view.xMin - s.x1) : s.x1;
+        float x2 = s.x2 > view.xMax ? s.x2 - std::ceil(s.x2 - view.xMax) : s.x2;
+        if (x1 <= x2)
+        {
+            sink.put(Span{ x1, s.y1, x2, s.y2 });
+        }
+    }
+};
+
+template <typename Sink>
+void FilledCircle(float xc, float yc, float r, const Viewport& view, Sink& sink) {
+    if (ShapeInside(xc, yc, r + 1, r + 1, view))
+    {
+        FilledCircle(xc, yc, r, sink);
+        return;
+    }
+    if (view.overlaps(xc - std::abs(r) - 1.0, yc - std::abs(r) - 1.0, xc + std::abs(r) + 1.0, yc + std::abs(r) + 1.0))
+    {
+        ViewportSpanSink<Sink> clip{ view, sink };
+        FilledCircle(xc, yc, r, clip);
+    }
+}
+
+template <typename Sink>
+void FilledEllipse(float xc, float yc, float rx, float ry, const Viewport& view, Sink& sink) {
+    if (ShapeInside(xc, yc, rx, ry, view))
+    {
+        FilledEllipse(xc, yc, rx, ry, sink);
+        return;
+    }
+    if (view.overlaps(xc - std::abs(rx) - 1.0, yc - std::abs(ry) - 1.0, xc + std::abs(rx) + 1.0, yc + std::abs(ry) + 1.0))
+    {
+        ViewportSpanSink<Sink> clip{ view, sink };
+        FilledEllipse(xc, yc, rx, ry, clip);
+    }
+}
+
+// by value like WuLine()
+std::vector<Span> FilledCircle(float xc, float yc, float r, Viewport view);
+std::vector<Span> FilledEllipse(float xc, float yc, float rx, float ry, Viewport view);
+
+// number of points the clipped Unique generators emit
+size_t MidpointCircleUniqueCount(float xc, float yc, float r, const Viewport& view);
+size_t MidpointEllipseUniqueCount(float xc, float yc, float rx, float ry, const Viewport& view);
+
+#endif
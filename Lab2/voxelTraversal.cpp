@@ -0,0 +1,27 @@
+#include "voxelTraversal.h"
+
+using namespace std;
+
+
+size_t VoxelBatchOffsets(const RayBatch& rays, std::vector<size_t>& offsets) {
+    offsets.resize(rays.size() + 1);
+    size_t total = 0;
+    for (size_t i = 0; i < rays.size(); i++) {
+        offsets[i] = total;
+        total += VoxelCount(rays.x0[i], rays.y0[i], rays.z0[i], rays.x1[i], rays.y1[i], rays.z1[i]);
+    }
+    offsets[rays.size()] = total;
+    return total;
+}
+
+void VoxelBatch(const RayBatch& rays, const size_t* offsets, Voxel* out) {
+    // every ray keeps its own write position, starting at its offset
+    std::vector<Voxel*> dst(rays.size());
+    for (size_t i = 0; i < rays.size(); i++) {
+        dst[i] = out + offsets[i];
+    }
+    TraverseVoxelBatch(rays, [&](size_t ray, int x, int y, int z) {
+        *dst[ray]++ = { x, y, z };
+        return true;
+    });
+}
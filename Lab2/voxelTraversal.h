@@ -0,0 +1,302 @@
+#ifndef VOXEL_TRAVERSAL_H
+#define VOXEL_TRAVERSAL_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include "simd.h"
+
+// Amanatides-Woo traversal: every voxel a segment passes through, in order,
+// one face step at a time. Voxel (x, y, z) covers [x, x+1) * [y, y+1) * [z, z+1).
+//
+// The end points are rounded to 1/VOXEL_SUBSTEPS of a voxel and the walk
+// only adds and compares integers, so the scalar and batch versions pick
+// exactly the same voxels. End points must be finite and within
+// VOXEL_COORDINATE_LIMIT voxels of the origin, a segment that is not visits
+// no voxels at all. The batch walk keeps its error terms in doubles, which
+// stay below 2^53 (see SimdD) only while the segment spans at most
+// VOXEL_LANE_SPAN voxels along each axis; longer rays take the integer walk.
+
+struct Voxel { int x, y, z; };
+
+const int64_t VOXEL_SUBSTEPS = 256;
+// every voxel index fits an int and every rounded end point an int64
+const float VOXEL_COORDINATE_LIMIT = 1 << 30;
+const int64_t VOXEL_LANE_SPAN = 1 << 17;
+
+// The segment crosses the next boundary of axis a at t = next[a] / delta[a].
+// Which of two axes gets there first is the sign of
+// next[a] * delta[b] - next[b] * delta[a], kept as a Bresenham style error
+// term per pair of axes. A step along a moves next[a] by one voxel, so the
+// terms only ever change by constants and the walk needs no multiplication.
+struct VoxelWalk {
+    int64_t cell[3];
+    int64_t step[3];    // +1 or -1
+    int64_t count[3];   // boundaries left to cross
+    int64_t xy, xz, yz; // error terms, negative when the first axis is earlier
+    int64_t move[3];    // VOXEL_SUBSTEPS * delta[a], what a step along a adds
+};
+
+// checked before a walk is set up, the comparisons are false for nan
+inline bool VoxelSegmentInRange(float x0, float y0, float z0, float x1, float y1, float z1) {
+    const float c[6] = { x0, y0, z0, x1, y1, z1 };
+    for (float v : c) {
+        if (!(std::fabs(v) < VOXEL_COORDINATE_LIMIT))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline int64_t FloorDiv(int64_t a, int64_t b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+inline VoxelWalk SetupVoxelWalk(float x0, float y0, float z0, float x1, float y1, float z1) {
+    const float from[3] = { x0, y0, z0 }, to[3] = { x1, y1, z1 };
+    VoxelWalk w;
+    int64_t next[3], delta[3];
+    for (int a = 0; a < 3; a++) {
+        int64_t p0 = std::llround(from[a] * VOXEL_SUBSTEPS), p1 = std::llround(to[a] * VOXEL_SUBSTEPS);
+        int64_t c0 = FloorDiv(p0, VOXEL_SUBSTEPS), c1 = FloorDiv(p1, VOXEL_SUBSTEPS);
+        w.cell[a] = c0;
+        w.step[a] = p1 < p0 ? -1 : 1;
+        w.count[a] = c1 < c0 ? c0 - c1 : c1 - c0;
+        next[a] = p1 < p0 ? p0 - c0 * VOXEL_SUBSTEPS : (c0 + 1) * VOXEL_SUBSTEPS - p0;
+        delta[a] = p1 < p0 ? p0 - p1 : p1 - p0;
+        w.move[a] = VOXEL_SUBSTEPS * delta[a];
+    }
+    w.xy = next[0] * delta[1] - next[1] * delta[0];
+    w.xz = next[0] * delta[2] - next[2] * delta[0];
+    w.yz = next[1] * delta[2] - next[2] * delta[1];
+    return w;
+}
+
+// steps into the next voxel, returns false at the last one. Axes without
+// boundaries left are skipped, so ending exactly on a face never steps
+// past the end; ties go to x, then y, then z. The choice is computed
+// rather than branched on, the axis order of a ray is hard to predict.
+inline bool AdvanceVoxelWalk(VoxelWalk& w) {
+    bool hx = w.count[0] > 0, hy = w.count[1] > 0, hz = w.count[2] > 0;
+    bool px = hx && (!hy || w.xy <= 0) && (!hz || w.xz <= 0);
+    bool py = !px && hy && (!hz || w.yz <= 0);
+    bool pz = !px && !py && hz;
+
+    w.cell[0] += px ? w.step[0] : 0, w.cell[1] += py ? w.step[1] : 0, w.cell[2] += pz ? w.step[2] : 0;
+    w.count[0] -= px, w.count[1] -= py, w.count[2] -= pz;
+    w.xy += px ? w.move[1] : py ? -w.move[0] : 0;
+    w.xz += px ? w.move[2] : pz ? -w.move[0] : 0;
+    w.yz += py ? w.move[2] : pz ? -w.move[1] : 0;
+    return px || py || pz;
+}
+
+// number of voxels TraverseVoxels() visits
+inline size_t VoxelCount(float x0, float y0, float z0, float x1, float y1, float z1) {
+    if (!VoxelSegmentInRange(x0, y0, z0, x1, y1, z1))
+    {
+        return 0;
+    }
+    VoxelWalk w = SetupVoxelWalk(x0, y0, z0, x1, y1, z1);
+    return (size_t)(1 + w.count[0] + w.count[1] + w.count[2]);
+}
+
+// calls visit(x, y, z) for every voxel from the start to the end. When
+// visit returns false the walk stops there and TraverseVoxels returns false.
+template <typename Visit>
+bool TraverseVoxels(float x0, float y0, float z0, float x1, float y1, float z1, Visit visit) {
+    if (!VoxelSegmentInRange(x0, y0, z0, x1, y1, z1))
+    {
+        return true;
+    }
+    VoxelWalk w = SetupVoxelWalk(x0, y0, z0, x1, y1, z1);
+    do {
+        if (!visit((int)w.cell[0], (int)w.cell[1], (int)w.cell[2]))
+        {
+            return false;
+        }
+    } while (AdvanceVoxelWalk(w));
+    return true;
+}
+
+// structure-of-arrays segment list for the batch walk, like LineBatch
+struct RayBatch {
+    std::vector<float> x0, y0, z0, x1, y1, z1;
+
+    void add(float ax, float ay, float az, float bx, float by, float bz) {
+        x0.push_back(ax), y0.push_back(ay), z0.push_back(az);
+        x1.push_back(bx), y1.push_back(by), z1.push_back(bz);
+    }
+    size_t size() const { return x0.size(); }
+};
+
+#if defined(SIMD_AVX2) || defined(SIMD_SSE2)
+// Walks SimdD::LANES rays side by side with the same choice as
+// AdvanceVoxelWalk(). A lane that is done, or whose visit returned false,
+// takes the next ray of the batch, so short or stopped rays do not leave
+// lanes idle until the longest ray of a group ends. A ray longer than
+// VOXEL_LANE_SPAN along some axis is walked whole with AdvanceVoxelWalk()
+// when its turn comes, its error terms would not be exact in a lane.
+template <typename Visit>
+void TraverseVoxelLanes(const RayBatch& rays, Visit& visit) {
+    typedef SimdD::V V;
+    const int N = SimdD::LANES;
+
+    // lane state lives in these arrays only while lanes are refilled
+    double cell[3][N], step[3][N], count[3][N], move[3][N], error[3][N];
+    size_t ray[N], next = 0;
+    int live = 0;
+    auto refill = [&](int free) {
+        for (int l = 0; l < N; l++) {
+            if (!(free & (1 << l)))
+            {
+                continue;
+            }
+            VoxelWalk w;
+            bool found = false;
+            while (!found && next < rays.size()) {
+                size_t r = next++;
+                if (!VoxelSegmentInRange(rays.x0[r], rays.y0[r], rays.z0[r], rays.x1[r], rays.y1[r], rays.z1[r]))
+                {
+                    continue;
+                }
+                w = SetupVoxelWalk(rays.x0[r], rays.y0[r], rays.z0[r], rays.x1[r], rays.y1[r], rays.z1[r]);
+                if (w.count[0] > VOXEL_LANE_SPAN || w.count[1] > VOXEL_LANE_SPAN || w.count[2] > VOXEL_LANE_SPAN)
+                {
+                    while (visit(r, (int)w.cell[0], (int)w.cell[1], (int)w.cell[2]) && AdvanceVoxelWalk(w)) {}
+                    continue;
+                }
+                ray[l] = r;
+                found = true;
+            }
+            if (!found)
+            {
+                // nothing left, the lane idles at the end of an empty walk
+                for (int a = 0; a < 3; a++) count[a][l] = 0;
+                continue;
+            }
+            for (int a = 0; a < 3; a++) {
+                cell[a][l] = (double)w.cell[a], step[a][l] = (double)w.step[a];
+                count[a][l] = (double)w.count[a], move[a][l] = (double)w.move[a];
+            }
+            error[0][l] = (double)w.xy, error[1][l] = (double)w.xz, error[2][l] = (double)w.yz;
+            live |= 1 << l;
+        }
+    };
+    refill((1 << N) - 1);
+
+    V c[3], s[3], n[3], m[3], e[3];
+    auto load = [&]() {
+        for (int a = 0; a < 3; a++) {
+            c[a] = SimdD::load(cell[a]), s[a] = SimdD::load(step[a]), n[a] = SimdD::load(count[a]);
+            m[a] = SimdD::load(move[a]), e[a] = SimdD::load(error[a]);
+        }
+    };
+    load();
+    const V zero = SimdD::zero(), one = SimdD::set1(1);
+
+    while (live) {
+        int x[N], y[N], z[N];
+        SimdD::storeInt(x, c[0]), SimdD::storeInt(y, c[1]), SimdD::storeInt(z, c[2]);
+        int stopped = 0;
+        for (int l = 0; l < N; l++) {
+            if ((live & (1 << l)) && !visit(ray[l], x[l], y[l], z[l]))
+            {
+                stopped |= 1 << l;
+            }
+        }
+
+        // e = { xy, xz, yz }, "e <= 0" is "not 0 < e", "!h || ok" is "not (h and not ok)"
+        V hx = SimdD::greater(n[0], zero), hy = SimdD::greater(n[1], zero), hz = SimdD::greater(n[2], zero);
+        V px = SimdD::andnot(SimdD::and_(hy, SimdD::less(zero, e[0])), hx);
+        px = SimdD::andnot(SimdD::and_(hz, SimdD::less(zero, e[1])), px);
+        V py = SimdD::andnot(px, SimdD::andnot(SimdD::and_(hz, SimdD::less(zero, e[2])), hy));
+        V pz = SimdD::andnot(SimdD::or_(px, py), hz);
+        int done = (live & ~SimdD::mask(SimdD::or_(hx, SimdD::or_(hy, hz)))) | stopped;
+
+        const V pick[3] = { px, py, pz };
+        for (int a = 0; a < 3; a++) {
+            c[a] = SimdD::add(c[a], SimdD::and_(pick[a], s[a]));
+            n[a] = SimdD::sub(n[a], SimdD::and_(pick[a], one));
+        }
+        e[0] = SimdD::sub(SimdD::add(e[0], SimdD::and_(px, m[1])), SimdD::and_(py, m[0]));
+        e[1] = SimdD::sub(SimdD::add(e[1], SimdD::and_(px, m[2])), SimdD::and_(pz, m[0]));
+        e[2] = SimdD::sub(SimdD::add(e[2], SimdD::and_(py, m[2])), SimdD::and_(pz, m[1]));
+
+        if (done)
+        {
+            live &= ~done;
+            for (int a = 0; a < 3; a++) {
+                SimdD::store(cell[a], c[a]), SimdD::store(step[a], s[a]), SimdD::store(count[a], n[a]);
+                SimdD::store(move[a], m[a]), SimdD::store(error[a], e[a]);
+            }
+            refill(done);
+            load();
+        }
+    }
+}
+#endif
+
+// TraverseVoxels() for every ray of the batch, SimdD::LANES rays at a
+// time. visit(ray, x, y, z) returning false stops only that ray. The
+// voxels of one ray arrive in order, different rays are interleaved.
+template <typename Visit>
+void TraverseVoxelBatch(const RayBatch& rays, Visit visit) {
+#if defined(SIMD_AVX2) || defined(SIMD_SSE2)
+    TraverseVoxelLanes(rays, visit);
+#else
+    for (size_t i = 0; i < rays.size(); i++) {
+        TraverseVoxels(rays.x0[i], rays.y0[i], rays.z0[i], rays.x1[i], rays.y1[i], rays.z1[i],
+            [&](int x, int y, int z) { return visit(i, x, y, z); });
+    }
+#endif
+}
+
+// fills offsets[0..n] with the start of every ray in the output buffer
+// and returns the total number of voxels the batch visits
+size_t VoxelBatchOffsets(const RayBatch& rays, std::vector<size_t>& offsets);
+
+// writes the voxels of ray i to out + offsets[i]
+void VoxelBatch(const RayBatch& rays, const size_t* offsets, Voxel* out);
+
+
+// one bit per voxel of a size^3 grid, for occupancy queries
+class OccupancyGrid {
+public:
+    explicit OccupancyGrid(int size) : n(size), bits(((size_t)size * size * size + 63) / 64) {}
+
+    int size() const { return n; }
+    bool contains(int x, int y, int z) const {
+        return (unsigned)x < (unsigned)n && (unsigned)y < (unsigned)n && (unsigned)z < (unsigned)n;
+    }
+    void set(int x, int y, int z) {
+        size_t i = index(x, y, z);
+        bits[i / 64] |= uint64_t(1) << (i % 64);
+    }
+    // voxels outside the grid are empty
+    bool occupied(int x, int y, int z) const {
+        if (!contains(x, y, z))
+        {
+            return false;
+        }
+        size_t i = index(x, y, z);
+        return (bits[i / 64] >> (i % 64)) & 1;
+    }
+
+private:
+    size_t index(int x, int y, int z) const { return ((size_t)z * n + y) * n + x; }
+
+    int n;
+    std::vector<uint64_t> bits;
+};
+
+// first occupied voxel along the segment, stopping the walk there
+inline bool FirstOccupied(const OccupancyGrid& grid, float x0, float y0, float z0, float x1, float y1, float z1, Voxel& hit) {
+    return !TraverseVoxels(x0, y0, z0, x1, y1, z1, [&](int x, int y, int z) {
+        hit = { x, y, z };
+        return !grid.occupied(x, y, z);
+    });
+}
+
+#endif
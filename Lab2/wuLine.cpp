@@ -0,0 +1,16 @@
+#include "wuLine.h"
+
+using namespace std;
+
+
+size_t WuLineCount(float x1, float y1, float x2, float y2) {
+    WuLineSetup s = SetupWuLine(x1, y1, x2, y2);
+    return s.xStart == s.xEnd ? 2 : 4 + 2 * (size_t)s.inner;
+}
+
+std::vector<CoveragePoint> WuLine(float x1, float y1, float x2, float y2) {
+    std::vector<CoveragePoint> points(WuLineCount(x1, y1, x2, y2));
+    CoverageBufferSink sink(points.data());
+    WuLine(x1, y1, x2, y2, sink);
+    return points;
+}
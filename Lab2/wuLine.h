@@ -0,0 +1,93 @@
+#ifndef WU_LINE_H
+#define WU_LINE_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "primitives.h"
+
+// pixel of an antialiased line and how much of it the line covers, 0..1
+struct CoveragePoint { float x, y, coverage; };
+
+// antialiased generators call sink.put(x, y, coverage)
+struct CoverageBufferSink {
+    CoveragePoint* out;
+
+    explicit CoverageBufferSink(CoveragePoint* buffer) : out(buffer) {}
+    void put(float x, float y, float coverage) { *out++ = { x, y, coverage }; }
+};
+
+
+// Xiaolin Wu's line walks the major axis one column at a time and splits
+// every column between the two pixels the exact line passes between.
+// The end columns are additionally weighted by how much of them the line spans.
+struct WuLineSetup {
+    bool steep;
+    float gradient;
+    float xStart, xEnd;       // first and last column, xStart <= xEnd
+    int64_t inner;            // columns strictly between them
+    float yStart, yEnd;       // exact minor coordinate on those columns
+    float gapStart, gapEnd;   // coverage of the end columns along the major axis
+};
+
+inline WuLineSetup SetupWuLine(float x1, float y1, float x2, float y2) {
+    WuLineSetup s;
+    s.steep = std::abs(y2 - y1) > std::abs(x2 - x1);
+    if (s.steep)
+    {
+        std::swap(x1, y1), std::swap(x2, y2);
+    }
+    if (x1 > x2)
+    {
+        std::swap(x1, x2), std::swap(y1, y2);
+    }
+
+    float dx = x2 - x1, dy = y2 - y1;
+    s.gradient = dx == 0 ? 1 : dy / dx;
+
+    auto fpart = [](float v) { return v - std::floor(v); };
+    s.xStart = std::floor(x1 + 0.5f);
+    s.yStart = y1 + s.gradient * (s.xStart - x1);
+    s.gapStart = 1 - fpart(x1 + 0.5f);
+    s.xEnd = std::floor(x2 + 0.5f);
+    s.yEnd = y2 + s.gradient * (s.xEnd - x2);
+    s.gapEnd = fpart(x2 + 0.5f);
+    // whole floats, their difference is exact in a double
+    double inner = (double)s.xEnd - s.xStart - 1;
+    s.inner = inner > 0 ? (int64_t)inner : 0;
+    return s;
+}
+
+// two pixels for each end column and for every column in between. A line
+// that starts and ends in the same column covers it once.
+size_t WuLineCount(float x1, float y1, float x2, float y2);
+
+template <typename Sink>
+void WuLine(float x1, float y1, float x2, float y2, Sink& sink) {
+    WuLineSetup s = SetupWuLine(x1, y1, x2, y2);
+    auto column = [&](float x, float y, float weight) {
+        float iy = std::floor(y), f = y - iy;
+        s.steep ? sink.put(iy, x, (1 - f) * weight) : sink.put(x, iy, (1 - f) * weight);
+        s.steep ? sink.put(iy + 1, x, f * weight) : sink.put(x, iy + 1, f * weight);
+    };
+
+    if (s.xStart == s.xEnd)
+    {
+        column(s.xStart, s.yStart, 1);
+        return;
+    }
+    column(s.xStart, s.yStart, s.gapStart);
+    // y is computed from the column instead of accumulated, so the clipped
+    // version can start anywhere. The count is an integer, a float counter
+    // stops advancing at 2^24.
+    for (int64_t k = 1; k <= s.inner; k++) {
+        column(s.xStart + (float)k, s.yStart + s.gradient * (float)k, 1);
+    }
+    column(s.xEnd, s.yEnd, s.gapEnd);
+}
+
+std::vector<CoveragePoint> WuLine(float x1, float y1, float x2, float y2);
+
+#endif